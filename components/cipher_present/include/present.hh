@@ -27,10 +27,13 @@
 #define BF642B3C_376F_42C7_B108_89E08CAB4283
 
 #include <cstdint>
+#include <cstddef>
 #include <vector>
 #include <random>
 #include <stdexcept>
 
+class Rng;
+
 /**
  * @brief Class implementing the PRESENT block cipher encryption
  */
@@ -44,6 +47,31 @@ public:
         KEY_128 = 128  ///< 128-bit key size
     };
 
+    /**
+     * @brief Enum selecting the implementation used by the batch API
+     */
+    enum class Engine {
+        Auto,      ///< Pick the fastest engine for the batch size
+        Scalar,    ///< One block at a time through encrypt()
+        Bitsliced, ///< 64 blocks per batch as bit-planes
+        Simd,      ///< Nibble-shuffle S-box over SIMD registers (widest available ISA)
+        Table      ///< Combined S-box/pLayer lookup tables, for small batches and hosts without SIMD
+    };
+
+    /**
+     * @brief Time spent in each phase of a counting call, in nanoseconds
+     *
+     * Filled by countDifferential() and countDifferentialRounds() when given
+     * one; the counters are added to, never reset. The bitsliced engine
+     * compares the differences while still in plane form, so its comparison
+     * time is part of encryptNanos.
+     */
+    struct CountProfile {
+        uint64_t rngNanos = 0;     ///< Drawing plaintexts and forming the pairs
+        uint64_t encryptNanos = 0; ///< Encrypting both halves of the pairs
+        uint64_t compareNanos = 0; ///< Comparing the output differences
+    };
+
     /**
      * @brief Constructor for Present cipher
      * 
@@ -61,6 +89,23 @@ public:
      */
     void setKey(const uint8_t* key, size_t keyLength);
 
+    /**
+     * @brief Set key on this cipher and the related key key ^ keyDifference on another
+     *
+     * Both schedules come from one pass over the key register: the related
+     * one is carried as a register difference, which rotates with the
+     * register and only needs an S-box lookup where it enters the schedule
+     * S-boxes. related.roundKey(r) ^ roundKey(r) is the round-key difference
+     * the related-key experiments study.
+     *
+     * @param key Pointer to the key bytes
+     * @param keyDifference Pointer to keyLength bytes XORed into key for the related key
+     * @param keyLength Length of the key in bytes (must match the selected KeySize)
+     * @param related Cipher receiving the related key, with the same key size and rounds
+     * @throws std::invalid_argument if key length doesn't match the KeySize or related differs
+     */
+    void setRelatedKeys(const uint8_t* key, const uint8_t* keyDifference, size_t keyLength, Present& related);
+
     /**
      * @brief Encrypt a plaintext block using PRESENT
      * 
@@ -70,6 +115,170 @@ public:
      */
     uint64_t encrypt(uint64_t plaintext) const;
 
+    /**
+     * @brief Encrypt a plaintext block and record the state after every round
+     *
+     * States follow decryptRounds(): states[i] is the value after i rounds, so
+     * states[0] is the plaintext and the returned ciphertext is
+     * states[rounds] ^ roundKey(rounds). Round keys do not depend on the round
+     * count, so states[i] ^ roundKey(i) is the ciphertext of the same key with
+     * i rounds.
+     *
+     * @param plaintext 64-bit plaintext block to encrypt
+     * @param states Output, rounds + 1 states
+     * @return uint64_t Resulting 64-bit ciphertext
+     * @throws std::runtime_error if key has not been set
+     */
+    uint64_t encryptTrace(uint64_t plaintext, uint64_t* states) const;
+
+    /**
+     * @brief Encrypt a batch of plaintext blocks
+     *
+     * Produces the same ciphertexts as calling encrypt() on every block.
+     *
+     * @param in Pointer to n plaintext blocks
+     * @param out Pointer to n ciphertext blocks (may be the same as in)
+     * @param n Number of blocks
+     * @param engine Implementation to use (Engine::Auto by default)
+     * @throws std::runtime_error if key has not been set
+     */
+    void encryptBlocks(const uint64_t* in, uint64_t* out, size_t n,
+                       Engine engine = Engine::Auto) const;
+
+    /**
+     * @brief Decrypt a single 64-bit block
+     *
+     * @param ciphertext 64-bit ciphertext block to decrypt
+     * @return uint64_t Resulting 64-bit plaintext
+     * @throws std::runtime_error if key has not been set
+     */
+    uint64_t decrypt(uint64_t ciphertext) const;
+
+    /**
+     * @brief Undo rounds toRound + 1 .. fromRound of the cipher
+     *
+     * States are counted before the final key addition: state i is the value
+     * after i rounds (addRoundKey, sBoxLayer, pLayer), so state 0 is the
+     * plaintext and the ciphertext is state rounds XOR roundKey(rounds). This
+     * is the partial decryption used when attacking the last rounds.
+     *
+     * @param state State after fromRound rounds
+     * @param fromRound Round count of the input state
+     * @param toRound Round count of the returned state (0 <= toRound <= fromRound <= rounds)
+     * @return uint64_t State after toRound rounds
+     * @throws std::runtime_error if key has not been set
+     * @throws std::out_of_range if the round indices are out of range
+     */
+    uint64_t decryptRounds(uint64_t state, int fromRound, int toRound) const;
+
+    /**
+     * @brief Decrypt a batch of ciphertext blocks
+     *
+     * Produces the same plaintexts as calling decrypt() on every block, with
+     * the same engines as encryptBlocks().
+     *
+     * @param in Pointer to n ciphertext blocks
+     * @param out Pointer to n plaintext blocks (may be the same as in)
+     * @param n Number of blocks
+     * @param engine Implementation to use (Engine::Auto by default)
+     * @throws std::runtime_error if key has not been set
+     */
+    void decryptBlocks(const uint64_t* in, uint64_t* out, size_t n,
+                       Engine engine = Engine::Auto) const;
+
+    /**
+     * @brief Round key of the current key
+     *
+     * @param round Round key index (0 .. rounds), round key 0 is added first
+     * @return uint64_t The round key
+     * @throws std::runtime_error if key has not been set
+     * @throws std::out_of_range if round is out of range
+     */
+    uint64_t roundKey(int round) const;
+
+    /**
+     * @brief Count right pairs of a differential over random plaintexts
+     *
+     * Draws n plaintexts p from rng and counts how many satisfy
+     * E(p) ^ E(p ^ alpha) == beta. Pairs are generated and encrypted in bulk;
+     * the bitsliced engine compares the differences in plane form. The count
+     * depends only on the key, the differential and the generator's output,
+     * not on the engine.
+     *
+     * @param alpha Input difference
+     * @param beta Output difference
+     * @param n Number of plaintext pairs
+     * @param rng Generator the first plaintext of every pair is drawn from
+     * @param engine Implementation to use (Engine::Auto by default)
+     * @param profile If not null, the time of each phase is added to it (a clock read per 1024 pairs)
+     * @return uint64_t Number of right pairs
+     * @throws std::runtime_error if key has not been set
+     */
+    uint64_t countDifferential(uint64_t alpha, uint64_t beta, uint64_t n, Rng& rng,
+                               Engine engine = Engine::Auto, CountProfile* profile = nullptr) const;
+
+    /**
+     * @brief Count right pairs of a differential, plaintexts from SplitMixRng(seed)
+     */
+    uint64_t countDifferential(uint64_t alpha, uint64_t beta, uint64_t n, uint64_t seed,
+                               Engine engine = Engine::Auto) const;
+
+    /**
+     * @brief Count right pairs against a target difference after every round
+     *
+     * Draws n plaintexts p from rng like countDifferential() and, for every
+     * round r, counts the pairs whose state difference after r + 1 rounds is
+     * betas[r]. The round key additions cancel in a difference, so hits[r] is
+     * the count countDifferential(alpha, betas[r], ...) gives for the same key
+     * with r + 1 rounds, and one pass over the plaintexts covers every prefix
+     * of a characteristic. The pairs are encrypted one round at a time in bulk.
+     *
+     * @param alpha Input difference
+     * @param betas rounds target differences, the last one is the output difference
+     * @param n Number of plaintext pairs
+     * @param rng Generator the first plaintext of every pair is drawn from
+     * @param hits Output, rounds counters (overwritten)
+     * @param engine Implementation to use (Engine::Auto by default)
+     * @param profile If not null, the time of each phase is added to it
+     * @throws std::runtime_error if key has not been set
+     */
+    void countDifferentialRounds(uint64_t alpha, const uint64_t* betas, uint64_t n, Rng& rng,
+                                 uint64_t* hits, Engine engine = Engine::Auto,
+                                 CountProfile* profile = nullptr) const;
+
+    /**
+     * @brief Count right pairs after every round, plaintexts from SplitMixRng(seed)
+     */
+    void countDifferentialRounds(uint64_t alpha, const uint64_t* betas, uint64_t n, uint64_t seed,
+                                 uint64_t* hits, Engine engine = Engine::Auto) const;
+
+    /**
+     * @brief Count plaintexts satisfying a linear approximation
+     *
+     * Draws n plaintexts p from rng and counts how many satisfy
+     * parity(p & inMask) == parity(E(p) & outMask); the correlation of the
+     * approximation is 2 * count / n - 1. Plaintexts are encrypted in bulk and
+     * the parities taken with popcount; the bitsliced engine XORs the selected
+     * bit-planes and counts 64 lanes per popcount. The count depends only on
+     * the key, the masks and the generator's output, not on the engine.
+     *
+     * @param inMask Plaintext mask
+     * @param outMask Ciphertext mask
+     * @param n Number of plaintexts
+     * @param rng Generator the plaintexts are drawn from
+     * @param engine Implementation to use (Engine::Auto by default)
+     * @return uint64_t Number of plaintexts for which the approximation holds
+     * @throws std::runtime_error if key has not been set
+     */
+    uint64_t countLinear(uint64_t inMask, uint64_t outMask, uint64_t n, Rng& rng,
+                         Engine engine = Engine::Auto) const;
+
+    /**
+     * @brief Count plaintexts satisfying a linear approximation, plaintexts from SplitMixRng(seed)
+     */
+    uint64_t countLinear(uint64_t inMask, uint64_t outMask, uint64_t n, uint64_t seed,
+                         Engine engine = Engine::Auto) const;
+
     /**
      * @brief Generate a random key for the current key size
      * 
@@ -84,7 +293,39 @@ public:
      */
     static uint64_t generateRandomPlaintext();
 
-private:
+    /**
+     * @brief Generate a key for the current key size from an explicit generator
+     *
+     * @param rng Generator to draw the key bytes from
+     * @return std::vector<uint8_t> Key of appropriate length
+     */
+    std::vector<uint8_t> generateRandomKey(Rng& rng) const;
+
+    /**
+     * @brief Generate a plaintext block from an explicit generator
+     *
+     * @param rng Generator to draw from
+     * @return uint64_t 64-bit plaintext
+     */
+    static uint64_t generateRandomPlaintext(Rng& rng);
+
+    /**
+     * @brief Name of the pLayer implementation used by the scalar path
+     *
+     * Chosen once per process by timing the implementations the CPU supports;
+     * PRESENT_PLAYER=pext|shift|table in the environment overrides the choice.
+     *
+     * @return const char* "pext", "shift" or "table"
+     */
+    static const char* permutationLayerImpl();
+
+    /**
+     * @brief Name of the instruction set used by Engine::Simd on this CPU
+     *
+     * @return const char* "avx512bw", "avx2", "ssse3" or "none"
+     */
+    static const char* simdInstructionSet();
+
     /**
      * S-box lookup table for PRESENT substitution layer (4-bit to 4-bit)
      */
@@ -93,6 +334,15 @@ private:
         0x3, 0xE, 0xF, 0x8, 0x4, 0x7, 0x1, 0x2
     };
 
+    /**
+     * Inverse S-box, INV_SBOX[SBOX[x]] == x
+     */
+    static constexpr uint8_t INV_SBOX[16] = {
+        0x5, 0xE, 0xF, 0x8, 0xC, 0x1, 0x2, 0xD,
+        0xB, 0x4, 0x6, 0x3, 0x0, 0x7, 0x9, 0xA
+    };
+
+private:
     /**
      * @brief Apply the substitution layer (S-box) to the state
      * 
@@ -109,6 +359,21 @@ private:
      */
     uint64_t applyPermutationLayer(uint64_t state) const;
 
+    /**
+     * @brief Apply the inverse substitution layer to the state
+     */
+    uint64_t applyInverseSubstitutionLayer(uint64_t state) const;
+
+    /**
+     * @brief Apply the inverse permutation layer to the state
+     */
+    uint64_t applyInversePermutationLayer(uint64_t state) const;
+
+    /**
+     * @brief Engine dispatch shared by encryptBlocks() and decryptBlocks()
+     */
+    void processBlocks(const uint64_t* in, uint64_t* out, size_t n, Engine engine, bool decrypt) const;
+
     /**
      * @brief Add a round key to the current state
      * 
@@ -130,6 +395,8 @@ private:
     int rounds_;                      ///< Number of rounds
     std::vector<uint64_t> roundKeys_; ///< Precomputed round keys
     bool keySet_;                     ///< Flag indicating if key has been set
+    uint64_t (*permutationLayer_)(uint64_t); ///< pLayer implementation selected for this CPU
+    uint64_t (*inversePermutationLayer_)(uint64_t); ///< Matching inverse pLayer
     static std::random_device rd_;    ///< Random device for key/plaintext generation
     static std::mt19937_64 gen_;      ///< Mersenne Twister RNG
 };
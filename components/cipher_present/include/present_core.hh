@@ -0,0 +1,447 @@
+/*
+ * File: present_core.hh
+ *
+ * Description:    constexpr building blocks of PRESENT shared by every implementation
+ *
+ * S-box layer, pLayer, their inverses and key-schedule steps as constexpr
+ * functions on plain 64-bit words. Present, PresentKeyBatch and the header-only PresentT are all
+ * built from these, so the round function and the key register convention are
+ * defined in one place.
+ *
+ * The key register is held as a 128-bit value in two words, bit p of the
+ * register being bit p of (hi:lo). For 80-bit keys only bits 79..0 are used.
+ *
+ * Copyright (c) 2025 Ahmet Çobanoğlu
+ * All rights reserved.
+ *
+ * This file is proprietary and confidential. Unauthorized copying, distribution,
+ * modification, or use of this file, via any medium, is strictly prohibited
+ * without express written permission from the copyright holder.
+ */
+
+#ifndef E7E26D52_3C84_4C76_A006_E0EA58A8376E
+#define E7E26D52_3C84_4C76_A006_E0EA58A8376E
+
+#include <cstdint>
+#include "present.hh"
+
+namespace present_detail {
+
+// ---- S-box layer ----
+
+constexpr uint64_t packSbox()
+{
+    uint64_t packed = 0;
+    for (int i = 0; i < 16; ++i) {
+        packed |= static_cast<uint64_t>(Present::SBOX[i]) << (4 * i);
+    }
+    return packed;
+}
+
+/**
+ * @brief The S-box packed into one word, entry x in bits 4x..4x+3
+ */
+constexpr uint64_t SBOX_PACKED = packSbox();
+
+/**
+ * @brief S-box of one nibble
+ */
+constexpr uint64_t sboxNibble(uint64_t x)
+{
+    return (SBOX_PACKED >> (4 * (x & 0x0F))) & 0x0F;
+}
+
+/**
+ * @brief S-box applied to both nibbles of every byte value
+ */
+struct SboxBytes {
+    uint8_t t[256];
+};
+
+constexpr SboxBytes makeSboxBytes()
+{
+    SboxBytes bytes = {};
+    for (int b = 0; b < 256; ++b) {
+        bytes.t[b] = static_cast<uint8_t>(sboxNibble(b) | (sboxNibble(b >> 4) << 4));
+    }
+    return bytes;
+}
+
+constexpr SboxBytes SBOX_BYTES = makeSboxBytes();
+
+/**
+ * @brief sBoxLayer: the S-box on all 16 nibbles, one byte lookup per two nibbles
+ */
+constexpr uint64_t sBoxLayer(uint64_t state)
+{
+    uint64_t substituted = 0;
+    for (int i = 0; i < 8; ++i) {
+        substituted |= static_cast<uint64_t>(SBOX_BYTES.t[(state >> (8 * i)) & 0xFF]) << (8 * i);
+    }
+    return substituted;
+}
+
+constexpr uint64_t packInverseSbox()
+{
+    uint64_t packed = 0;
+    for (int i = 0; i < 16; ++i) {
+        packed |= static_cast<uint64_t>(Present::INV_SBOX[i]) << (4 * i);
+    }
+    return packed;
+}
+
+/**
+ * @brief The inverse S-box packed into one word
+ */
+constexpr uint64_t INV_SBOX_PACKED = packInverseSbox();
+
+/**
+ * @brief Inverse S-box of one nibble
+ */
+constexpr uint64_t invSboxNibble(uint64_t x)
+{
+    return (INV_SBOX_PACKED >> (4 * (x & 0x0F))) & 0x0F;
+}
+
+constexpr SboxBytes makeInverseSboxBytes()
+{
+    SboxBytes bytes = {};
+    for (int b = 0; b < 256; ++b) {
+        bytes.t[b] = static_cast<uint8_t>(invSboxNibble(b) | (invSboxNibble(b >> 4) << 4));
+    }
+    return bytes;
+}
+
+constexpr SboxBytes INV_SBOX_BYTES = makeInverseSboxBytes();
+
+/**
+ * @brief Inverse sBoxLayer
+ */
+constexpr uint64_t invSBoxLayer(uint64_t state)
+{
+    uint64_t substituted = 0;
+    for (int i = 0; i < 8; ++i) {
+        substituted |= static_cast<uint64_t>(INV_SBOX_BYTES.t[(state >> (8 * i)) & 0xFF]) << (8 * i);
+    }
+    return substituted;
+}
+
+// ---- pLayer ----
+
+/**
+ * @brief Position of bit i after pLayer: P(i) = 16 * i mod 63, P(63) = 63
+ */
+constexpr int permutedBit(int i)
+{
+    return (i == 63) ? 63 : (16 * i) % 63;
+}
+
+/**
+ * @brief Position of bit i after the inverse pLayer: 4 * i mod 63, 63 stays
+ */
+constexpr int inversePermutedBit(int i)
+{
+    return (i == 63) ? 63 : (4 * i) % 63;
+}
+
+// Writing i = 4a + b, pLayer maps the index bits (a3 a2 a1 a0 b1 b0) to
+// (b1 b0 a3 a2 a1 a0). That is four swaps of index bits, (0,2), (1,3), (2,4)
+// and (3,5), each of which is a delta swap with the mask and shift below.
+constexpr uint64_t PLAYER_MASK_3 = 0x0A0A0A0A0A0A0A0AULL;
+constexpr uint64_t PLAYER_MASK_6 = 0x00CC00CC00CC00CCULL;
+constexpr uint64_t PLAYER_MASK_12 = 0x0000F0F00000F0F0ULL;
+constexpr uint64_t PLAYER_MASK_24 = 0x00000000FF00FF00ULL;
+
+/**
+ * @brief Exchange the bits selected by m with the bits s positions above them
+ */
+constexpr uint64_t deltaSwap(uint64_t x, uint64_t m, int s)
+{
+    const uint64_t t = ((x >> s) ^ x) & m;
+    return x ^ t ^ (t << s);
+}
+
+/**
+ * @brief pLayer as four delta swaps
+ */
+constexpr uint64_t pLayerShift(uint64_t x)
+{
+    x = deltaSwap(x, PLAYER_MASK_3, 3);
+    x = deltaSwap(x, PLAYER_MASK_6, 6);
+    x = deltaSwap(x, PLAYER_MASK_12, 12);
+    return deltaSwap(x, PLAYER_MASK_24, 24);
+}
+
+/**
+ * @brief Inverse pLayer: the same delta swaps in reverse order
+ */
+constexpr uint64_t invPLayerShift(uint64_t x)
+{
+    x = deltaSwap(x, PLAYER_MASK_24, 24);
+    x = deltaSwap(x, PLAYER_MASK_12, 12);
+    x = deltaSwap(x, PLAYER_MASK_6, 6);
+    return deltaSwap(x, PLAYER_MASK_3, 3);
+}
+
+// ---- Combined S-box/pLayer tables ----
+
+/**
+ * @brief Combined S-box/pLayer tables, one 256-entry table per state byte
+ *
+ * Entry b of table j is the permuted S-box output of byte value b placed at
+ * byte j, so a round is eight lookups and XORs.
+ */
+struct SpTables {
+    uint64_t t[8][256];
+};
+
+constexpr SpTables makeSpTables()
+{
+    SpTables tables = {};
+    for (int j = 0; j < 8; ++j) {
+        for (int b = 0; b < 256; ++b) {
+            const uint64_t substituted = SBOX_BYTES.t[b];
+            uint64_t permuted = 0;
+            for (int bit = 0; bit < 8; ++bit) {
+                if ((substituted >> bit) & 1) {
+                    permuted |= 1ULL << permutedBit(8 * j + bit);
+                }
+            }
+            tables.t[j][b] = permuted;
+        }
+    }
+    return tables;
+}
+
+// A static member of a class template has a single definition across all
+// translation units, unlike a namespace-scope constexpr variable.
+template <typename T = void>
+struct SpTablesHolder {
+    alignas(64) static constexpr SpTables value = makeSpTables();
+};
+
+template <typename T>
+constexpr SpTables SpTablesHolder<T>::value;
+
+/**
+ * @brief The compile-time generated S-box/pLayer tables (16 KB, 64-byte aligned)
+ */
+constexpr const SpTables& spTables()
+{
+    return SpTablesHolder<>::value;
+}
+
+/**
+ * @brief Apply one S-box layer and pLayer through the tables
+ */
+constexpr uint64_t tableRound(uint64_t state)
+{
+    return spTables().t[0][state & 0xFF] ^
+           spTables().t[1][(state >> 8) & 0xFF] ^
+           spTables().t[2][(state >> 16) & 0xFF] ^
+           spTables().t[3][(state >> 24) & 0xFF] ^
+           spTables().t[4][(state >> 32) & 0xFF] ^
+           spTables().t[5][(state >> 40) & 0xFF] ^
+           spTables().t[6][(state >> 48) & 0xFF] ^
+           spTables().t[7][state >> 56];
+}
+
+// Decryption applies the inverse pLayer before the inverse S-box, which does
+// not split into per-byte lookups. Tracking y = invP(state) instead gives
+// y' = invP(invS(y)) ^ invP(K): the inverse S-box first, then the inverse
+// pLayer, which does.
+constexpr SpTables makeInverseSpTables()
+{
+    SpTables tables = {};
+    for (int j = 0; j < 8; ++j) {
+        for (int b = 0; b < 256; ++b) {
+            const uint64_t substituted = INV_SBOX_BYTES.t[b];
+            uint64_t permuted = 0;
+            for (int bit = 0; bit < 8; ++bit) {
+                if ((substituted >> bit) & 1) {
+                    permuted |= 1ULL << inversePermutedBit(8 * j + bit);
+                }
+            }
+            tables.t[j][b] = permuted;
+        }
+    }
+    return tables;
+}
+
+template <typename T = void>
+struct InverseSpTablesHolder {
+    alignas(64) static constexpr SpTables value = makeInverseSpTables();
+};
+
+template <typename T>
+constexpr SpTables InverseSpTablesHolder<T>::value;
+
+/**
+ * @brief The inverse tables: entry b of table j is invP(invS(b) << 8j)
+ */
+constexpr const SpTables& inverseSpTables()
+{
+    return InverseSpTablesHolder<>::value;
+}
+
+/**
+ * @brief invP(invS(y)) through the inverse tables
+ */
+constexpr uint64_t invTableRound(uint64_t y)
+{
+    return inverseSpTables().t[0][y & 0xFF] ^
+           inverseSpTables().t[1][(y >> 8) & 0xFF] ^
+           inverseSpTables().t[2][(y >> 16) & 0xFF] ^
+           inverseSpTables().t[3][(y >> 24) & 0xFF] ^
+           inverseSpTables().t[4][(y >> 32) & 0xFF] ^
+           inverseSpTables().t[5][(y >> 40) & 0xFF] ^
+           inverseSpTables().t[6][(y >> 48) & 0xFF] ^
+           inverseSpTables().t[7][y >> 56];
+}
+
+/**
+ * @brief One full round: addRoundKey, sBoxLayer, pLayer
+ */
+constexpr uint64_t presentRound(uint64_t state, uint64_t roundKey)
+{
+    return tableRound(state ^ roundKey);
+}
+
+// ---- Key schedule ----
+
+/**
+ * @brief Reverse the bit order of a byte
+ */
+constexpr uint64_t reverseByte(uint8_t b)
+{
+    b = static_cast<uint8_t>((b >> 4) | (b << 4));
+    b = static_cast<uint8_t>(((b & 0xCC) >> 2) | ((b & 0x33) << 2));
+    b = static_cast<uint8_t>(((b & 0xAA) >> 1) | ((b & 0x55) << 1));
+    return b;
+}
+
+/**
+ * @brief Load a master key into the key register
+ *
+ * Byte i of the master key fills register bits 8i..8i+7 with its most
+ * significant bit at 8i, i.e. bit-reversed.
+ *
+ * @param key Master key bytes
+ * @param keyLenBytes 10 or 16
+ * @param lo Register bits 63..0
+ * @param hi Register bits 127..64
+ */
+constexpr void loadKeyRegister(const uint8_t* key, int keyLenBytes, uint64_t& lo, uint64_t& hi)
+{
+    lo = 0;
+    hi = 0;
+    for (int i = 0; i < keyLenBytes; ++i) {
+        const uint64_t b = reverseByte(key[i]);
+        if (i < 8) {
+            lo |= b << (8 * i);
+        } else {
+            hi |= b << (8 * (i - 8));
+        }
+    }
+}
+
+/**
+ * @brief Round counter term XORed into register bits k_19..k_15
+ *
+ * @param round_idx 0-based index of the round key just extracted
+ */
+constexpr uint64_t roundCounter(int round_idx)
+{
+    return static_cast<uint64_t>((round_idx + 1) & 0x1F) << 15;
+}
+
+/**
+ * @brief Round key held in the register: its leftmost 64 bits
+ *
+ * @param keyBits 80 or 128
+ */
+constexpr uint64_t registerRoundKey(int keyBits, uint64_t lo, uint64_t hi)
+{
+    return (keyBits == 80) ? (hi << 48) | (lo >> 16) : hi;
+}
+
+/**
+ * @brief Rotate the key register left by 61 bits
+ *
+ * @param keyBits 80 or 128
+ * @param lo Register bits 63..0, updated
+ * @param hi Register bits 127..64, updated
+ */
+constexpr void rotateKeyRegister(int keyBits, uint64_t& lo, uint64_t& hi)
+{
+    uint64_t newLo = 0;
+    uint64_t newHi = 0;
+    if (keyBits == 80) {
+        // 80-bit register: bits 79..64 in hi. Left by 61 = right by 19 within 80 bits.
+        newLo = (lo >> 19) | (hi << 45) | (lo << 61);
+        newHi = (lo >> 3) & 0xFFFF;
+    } else {
+        // 128-bit register: two funnel shifts
+        newHi = (hi << 61) | (lo >> 3);
+        newLo = (lo << 61) | (hi >> 3);
+    }
+    lo = newLo;
+    hi = newHi;
+}
+
+/**
+ * @brief Advance the key register past round key round_idx
+ *
+ * Rotates left by 61 bits, applies the S-box to the top nibble (the top two
+ * for 128-bit keys) and XORs in the round counter.
+ *
+ * @param keyBits 80 or 128
+ * @param lo Register bits 63..0, updated
+ * @param hi Register bits 127..64, updated
+ * @param round_idx 0-based index of the round key just extracted
+ */
+constexpr void updateKeyRegister(int keyBits, uint64_t& lo, uint64_t& hi, int round_idx)
+{
+    rotateKeyRegister(keyBits, lo, hi);
+    if (keyBits == 80) {
+        hi = (hi & 0x0FFF) | (sboxNibble(hi >> 12) << 12);
+    } else {
+        hi = (hi & 0x00FFFFFFFFFFFFFFULL)
+           | (sboxNibble(hi >> 60) << 60)
+           | (sboxNibble(hi >> 56) << 56);
+    }
+    lo ^= roundCounter(round_idx);
+}
+
+/**
+ * @brief Advance the difference between the registers of a key and a related key
+ *
+ * The difference rotates with the register, and the round counter, added to
+ * both keys, cancels. Only a schedule S-box whose input difference d is not
+ * zero needs the register: its output difference is S(x) ^ S(x ^ d), with x
+ * recovered from the S-box output in the updated register of the key.
+ *
+ * @param keyBits 80 or 128
+ * @param hi Bits 127..64 of the key's register after updateKeyRegister()
+ * @param dLo Register difference bits 63..0 before the update, updated
+ * @param dHi Register difference bits 127..64 before the update, updated
+ */
+constexpr void updateKeyDifference(int keyBits, uint64_t hi, uint64_t& dLo, uint64_t& dHi)
+{
+    rotateKeyRegister(keyBits, dLo, dHi);
+    const int top = keyBits == 80 ? 12 : 60;
+    const int sboxes = keyBits == 80 ? 1 : 2;
+    for (int i = 0; i < sboxes; ++i) {
+        const int shift = top - 4 * i;
+        const uint64_t d = (dHi >> shift) & 0xF;
+        if (d != 0) {
+            const uint64_t y = (hi >> shift) & 0xF;
+            const uint64_t x = invSboxNibble(y);
+            dHi ^= (d ^ y ^ sboxNibble(x ^ d)) << shift;
+        }
+    }
+}
+
+} // namespace present_detail
+
+#endif /* E7E26D52_3C84_4C76_A006_E0EA58A8376E */
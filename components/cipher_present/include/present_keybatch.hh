@@ -0,0 +1,97 @@
+/*
+ * File: present_keybatch.hh
+ *
+ * Description:    Multi-key (key-bitsliced) PRESENT key schedule and encryption
+ *
+ * PresentKeyBatch expands many master keys at once and encrypts plaintexts
+ * under every one of them. Keys are processed in groups of 64: the key
+ * registers are transposed into bit-planes so that one 64-bit word carries a
+ * register bit of 64 keys, the rotation becomes a change of plane offset and
+ * the key-schedule S-box is the bitsliced S-box circuit. The resulting round
+ * key planes feed the bitsliced encryption directly, with each lane using its
+ * own key.
+ *
+ * Copyright (c) 2025 Ahmet Çobanoğlu
+ * All rights reserved.
+ *
+ * This file is proprietary and confidential. Unauthorized copying, distribution,
+ * modification, or use of this file, via any medium, is strictly prohibited
+ * without express written permission from the copyright holder.
+ */
+
+#ifndef DD464D6C_A1A3_4719_8388_09EC967B7FBA
+#define DD464D6C_A1A3_4719_8388_09EC967B7FBA
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "present.hh"
+
+/**
+ * @brief PRESENT under many keys at once
+ */
+class PresentKeyBatch {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param keySize Size of every key in the batch
+     * @param rounds Number of rounds to perform
+     */
+    PresentKeyBatch(Present::KeySize keySize = Present::KeySize::KEY_80, int rounds = 31);
+
+    /**
+     * @brief Expand the schedules of a set of master keys
+     *
+     * @param keys numKeys keys of keySize / 8 bytes each, stored back to back
+     * @param numKeys Number of keys
+     */
+    void setKeys(const uint8_t* keys, size_t numKeys);
+
+    /**
+     * @brief Number of keys currently loaded
+     */
+    size_t size() const { return numKeys_; }
+
+    /**
+     * @brief Encrypt one plaintext under every key
+     *
+     * @param plaintext 64-bit plaintext block
+     * @param out size() ciphertexts, out[k] under key k
+     * @throws std::runtime_error if no keys have been set
+     */
+    void encrypt(uint64_t plaintext, uint64_t* out) const;
+
+    /**
+     * @brief Encrypt a set of plaintexts under every key
+     *
+     * @param plaintexts numPlaintexts plaintext blocks
+     * @param numPlaintexts Number of plaintexts
+     * @param out numPlaintexts * size() ciphertexts, out[p * size() + k] is
+     *            plaintext p under key k
+     * @throws std::runtime_error if no keys have been set
+     */
+    void encryptBlocks(const uint64_t* plaintexts, size_t numPlaintexts, uint64_t* out) const;
+
+    /**
+     * @brief Round key of one key in the batch
+     *
+     * @param keyIndex Index of the key (0 .. size() - 1)
+     * @param round Round key index (0 .. rounds)
+     * @return uint64_t The round key
+     */
+    uint64_t roundKey(size_t keyIndex, int round) const;
+
+private:
+    /**
+     * @brief Bitsliced round keys of a group of 64 keys
+     */
+    const uint64_t* groupKeyPlanes(size_t group) const;
+
+    Present::KeySize keySize_;       ///< Key size of every key
+    int rounds_;                     ///< Number of rounds
+    size_t numKeys_;                 ///< Number of keys loaded
+    std::vector<uint64_t> keyPlanes_; ///< Per group: (rounds_ + 1) * 64 round key planes
+};
+
+#endif /* DD464D6C_A1A3_4719_8388_09EC967B7FBA */
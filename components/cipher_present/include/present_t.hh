@@ -0,0 +1,110 @@
+/*
+ * File: present_t.hh
+ *
+ * Description:    Header-only PRESENT specialised at compile time
+ *
+ * PresentT<Rounds, K> fixes the round count and key size as template
+ * parameters. The round keys live in a std::array inside the object and
+ * encrypt() is noexcept with its rounds unrolled at compile time, so a call
+ * can be inlined into the caller's loop. It is built from the same constexpr
+ * round function and key schedule as Present (present_core.hh) and produces
+ * the same ciphertexts; Present remains the runtime-configurable class with
+ * the batch engines.
+ *
+ * Copyright (c) 2025 Ahmet Çobanoğlu
+ * All rights reserved.
+ *
+ * This file is proprietary and confidential. Unauthorized copying, distribution,
+ * modification, or use of this file, via any medium, is strictly prohibited
+ * without express written permission from the copyright holder.
+ */
+
+#ifndef A27653C6_6AA5_41AA_B3E9_AA364A65DA39
+#define A27653C6_6AA5_41AA_B3E9_AA364A65DA39
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "present.hh"
+#include "present_core.hh"
+
+/**
+ * @brief PRESENT with the round count and key size fixed at compile time
+ *
+ * @tparam Rounds Number of rounds (1 .. 31)
+ * @tparam K Key size
+ */
+template <int Rounds, Present::KeySize K>
+class PresentT {
+    static_assert(Rounds >= 1 && Rounds <= 31, "PRESENT has between 1 and 31 rounds");
+
+public:
+    static constexpr int ROUNDS = Rounds;                                     ///< Number of rounds
+    static constexpr size_t KEY_BYTES = static_cast<size_t>(K) / 8;          ///< Master key length
+    typedef std::array<uint64_t, Rounds + 1> RoundKeys;                      ///< Round keys K_1 .. K_{Rounds+1}
+
+    /**
+     * @brief Constructor, all round keys zero until setKey() is called
+     */
+    PresentT() noexcept : roundKeys_() {}
+
+    /**
+     * @brief Constructor that expands a master key
+     *
+     * @param key Master key of KEY_BYTES bytes
+     */
+    explicit PresentT(const uint8_t* key) noexcept { setKey(key); }
+
+    /**
+     * @brief Expand a master key into the round keys
+     *
+     * @param key Master key of KEY_BYTES bytes
+     */
+    void setKey(const uint8_t* key) noexcept
+    {
+        const int keyBits = static_cast<int>(K);
+        uint64_t lo = 0;
+        uint64_t hi = 0;
+        present_detail::loadKeyRegister(key, static_cast<int>(KEY_BYTES), lo, hi);
+        for (int round_idx = 0; round_idx < Rounds + 1; ++round_idx) {
+            roundKeys_[round_idx] = present_detail::registerRoundKey(keyBits, lo, hi);
+            present_detail::updateKeyRegister(keyBits, lo, hi, round_idx);
+        }
+    }
+
+    /**
+     * @brief Encrypt one block, all rounds unrolled
+     *
+     * @param plaintext 64-bit plaintext block
+     * @return uint64_t 64-bit ciphertext
+     */
+    uint64_t encrypt(uint64_t plaintext) const noexcept
+    {
+        return applyRounds(plaintext, std::integral_constant<int, 0>()) ^ roundKeys_[Rounds];
+    }
+
+    /**
+     * @brief The expanded round keys
+     */
+    const RoundKeys& roundKeys() const noexcept { return roundKeys_; }
+
+private:
+    // Round I, then rounds I + 1 .. Rounds - 1 by recursion; the compiler sees
+    // straight-line code with every round key index a constant.
+    template <int I>
+    uint64_t applyRounds(uint64_t state, std::integral_constant<int, I>) const noexcept
+    {
+        return applyRounds(present_detail::presentRound(state, roundKeys_[I]),
+                           std::integral_constant<int, I + 1>());
+    }
+
+    uint64_t applyRounds(uint64_t state, std::integral_constant<int, Rounds>) const noexcept
+    {
+        return state;
+    }
+
+    RoundKeys roundKeys_; ///< Round keys K_1 .. K_{Rounds+1}
+};
+
+#endif /* A27653C6_6AA5_41AA_B3E9_AA364A65DA39 */
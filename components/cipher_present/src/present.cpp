@@ -1,11 +1,17 @@
-#include <iostream>
-#include <iomanip>
-#include <bitset>
-#include <immintrin.h> // For _pext_u64
+#include <algorithm>
+#include <chrono>
 #include "present.hh"
+#include "present_bitslice.hh"
+#include "present_core.hh"
+#include "present_player.hh"
+#include "present_rng.hh"
+#include "present_simd.hh"
+#include "present_table.hh"
 
 Present::Present(Present::KeySize keySize, int rounds)
-    : keySize_(keySize), rounds_(rounds), keySet_(false)
+    : keySize_(keySize), rounds_(rounds), keySet_(false),
+      permutationLayer_(present_detail::permutationLayer().fn),
+      inversePermutationLayer_(present_detail::permutationLayer().inverse)
 {
     roundKeys_.resize(rounds_ + 1); // Pre-allocate space for round keys
     // All necessary member initializations are handled by the member initializer list
@@ -26,6 +32,50 @@ void Present::setKey(const uint8_t* key, size_t keyLength)
     keySet_ = true;
 }
 
+namespace {
+
+// Both schedules of setRelatedKeys(), the key size fixed at compile time
+template <int KeyBits>
+void expandRelatedSchedules(uint64_t lo, uint64_t hi, uint64_t dLo, uint64_t dHi, int rounds, uint64_t* keys,
+                            uint64_t* relatedKeys)
+{
+    for (int round_idx = 0; round_idx < rounds + 1; ++round_idx) {
+        keys[round_idx] = present_detail::registerRoundKey(KeyBits, lo, hi);
+        relatedKeys[round_idx] = keys[round_idx] ^ present_detail::registerRoundKey(KeyBits, dLo, dHi);
+        present_detail::updateKeyRegister(KeyBits, lo, hi, round_idx);
+        present_detail::updateKeyDifference(KeyBits, hi, dLo, dHi);
+    }
+}
+
+} // namespace
+
+void Present::setRelatedKeys(const uint8_t* key, const uint8_t* keyDifference, size_t keyLength,
+                             Present& related)
+{
+    size_t expectedKeyLengthBytes = static_cast<size_t>(keySize_) / 8;
+    if (keyLength != expectedKeyLengthBytes) {
+        throw std::invalid_argument("Key length does not match selected KeySize.");
+    }
+    if (related.keySize_ != keySize_ || related.rounds_ != rounds_) {
+        throw std::invalid_argument("Related cipher must have the same key size and rounds.");
+    }
+
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+    uint64_t dLo = 0;
+    uint64_t dHi = 0;
+    present_detail::loadKeyRegister(key, static_cast<int>(keyLength), lo, hi);
+    present_detail::loadKeyRegister(keyDifference, static_cast<int>(keyLength), dLo, dHi);
+
+    if (keySize_ == KeySize::KEY_80) {
+        expandRelatedSchedules<80>(lo, hi, dLo, dHi, rounds_, roundKeys_.data(), related.roundKeys_.data());
+    } else {
+        expandRelatedSchedules<128>(lo, hi, dLo, dHi, rounds_, roundKeys_.data(), related.roundKeys_.data());
+    }
+    keySet_ = true;
+    related.keySet_ = true;
+}
+
 uint64_t Present::encrypt(uint64_t plaintext) const
 {
     if (!keySet_) {
@@ -41,22 +91,395 @@ uint64_t Present::encrypt(uint64_t plaintext) const
         state = addRoundKey(state, roundKeys_[i]);
         state = applySubstitutionLayer(state);
         state = applyPermutationLayer(state);
-
-#ifdef DEBUG
-        std::cout << "After round " << i + 1 << ": " << std::hex << std::setw(16) << std::setfill('0') << state << std::dec << std::endl;
-#endif
     }
 
     // Final addRoundKey with K_{rounds_+1} (which is roundKeys_[rounds_])
     state = addRoundKey(state, roundKeys_[rounds_]);
 
-#ifdef DEBUG
-    std::cout << "Final ciphertext: " << std::hex << std::setw(16) << std::setfill('0') << state << std::dec << std::endl;
-#endif
+    return state;
+}
 
+uint64_t Present::encryptTrace(uint64_t plaintext, uint64_t* states) const
+{
+    if (!keySet_) {
+        throw std::runtime_error("Key has not been set. Call setKey() before encryption.");
+    }
+
+    uint64_t state = plaintext;
+    states[0] = state;
+    for (int i = 0; i < rounds_; ++i) {
+        state = addRoundKey(state, roundKeys_[i]);
+        state = applySubstitutionLayer(state);
+        state = applyPermutationLayer(state);
+        states[i + 1] = state;
+    }
+
+    return addRoundKey(state, roundKeys_[rounds_]);
+}
+
+void Present::encryptBlocks(const uint64_t* in, uint64_t* out, size_t n, Engine engine) const
+{
+    processBlocks(in, out, n, engine, false);
+}
+
+uint64_t Present::decrypt(uint64_t ciphertext) const
+{
+    if (!keySet_) {
+        throw std::runtime_error("Key has not been set. Call setKey() before decryption.");
+    }
+
+    uint64_t state = addRoundKey(ciphertext, roundKeys_[rounds_]);
+    for (int i = rounds_ - 1; i >= 0; --i) {
+        state = applyInversePermutationLayer(state);
+        state = applyInverseSubstitutionLayer(state);
+        state = addRoundKey(state, roundKeys_[i]);
+    }
     return state;
 }
 
+uint64_t Present::decryptRounds(uint64_t state, int fromRound, int toRound) const
+{
+    if (!keySet_) {
+        throw std::runtime_error("Key has not been set. Call setKey() before decryption.");
+    }
+    if (toRound < 0 || toRound > fromRound || fromRound > rounds_) {
+        throw std::out_of_range("Round indices out of range for partial decryption.");
+    }
+
+    // State i + 1 = pLayer(sBoxLayer(state i ^ K_i)), undone one round at a time
+    for (int i = fromRound - 1; i >= toRound; --i) {
+        state = applyInversePermutationLayer(state);
+        state = applyInverseSubstitutionLayer(state);
+        state = addRoundKey(state, roundKeys_[i]);
+    }
+    return state;
+}
+
+void Present::decryptBlocks(const uint64_t* in, uint64_t* out, size_t n, Engine engine) const
+{
+    processBlocks(in, out, n, engine, true);
+}
+
+uint64_t Present::roundKey(int round) const
+{
+    if (!keySet_) {
+        throw std::runtime_error("Key has not been set. Call setKey() first.");
+    }
+    if (round < 0 || round > rounds_) {
+        throw std::out_of_range("Round key index out of range.");
+    }
+    return roundKeys_[round];
+}
+
+void Present::processBlocks(const uint64_t* in, uint64_t* out, size_t n, Engine engine, bool decrypt) const
+{
+    if (!keySet_) {
+        throw std::runtime_error(decrypt ? "Key has not been set. Call setKey() before decryption."
+                                         : "Key has not been set. Call setKey() before encryption.");
+    }
+
+    size_t done = 0;
+
+    // Auto prefers the SIMD engine from AVX2 upwards; with SSSE3 alone the
+    // bitsliced engine is faster.
+    const present_detail::SimdLevel level = present_detail::simdLevel();
+    if ((engine == Engine::Simd && level != present_detail::SimdLevel::None) ||
+        (engine == Engine::Auto && level >= present_detail::SimdLevel::Avx2)) {
+        if (decrypt) {
+            present_detail::simdDecryptBlocks(in, out, n, roundKeys_.data(), rounds_);
+        } else {
+            present_detail::simdEncryptBlocks(in, out, n, roundKeys_.data(), rounds_);
+        }
+        return;
+    }
+
+    if (engine == Engine::Table) {
+        if (decrypt) {
+            present_detail::tableDecryptBlocks(in, out, n, roundKeys_.data(), rounds_);
+        } else {
+            present_detail::tableEncryptBlocks(in, out, n, roundKeys_.data(), rounds_);
+        }
+        return;
+    }
+
+    if (engine == Engine::Auto || engine == Engine::Bitsliced) {
+        const size_t width = present_detail::BITSLICE_WIDTH;
+        // Auto leaves a partial tail to the table engine, Bitsliced pads it.
+        size_t bulk = (engine == Engine::Auto) ? n - n % width : n;
+        if (bulk > 0) {
+            std::vector<uint64_t> keyPlanes(static_cast<size_t>(rounds_ + 1) * 64);
+            present_detail::expandKeyPlanes(roundKeys_.data(), rounds_, keyPlanes.data());
+            for (; done < bulk; done += width) {
+                int count = static_cast<int>(bulk - done < width ? bulk - done : width);
+                if (decrypt) {
+                    present_detail::bitslicedDecryptBlocks(in + done, out + done, count,
+                                                           keyPlanes.data(), rounds_);
+                } else {
+                    present_detail::bitslicedEncryptBlocks(in + done, out + done, count,
+                                                           keyPlanes.data(), rounds_);
+                }
+            }
+        }
+    }
+
+    if (engine == Engine::Auto) {
+        if (decrypt) {
+            present_detail::tableDecryptBlocks(in + done, out + done, n - done, roundKeys_.data(), rounds_);
+        } else {
+            present_detail::tableEncryptBlocks(in + done, out + done, n - done, roundKeys_.data(), rounds_);
+        }
+        return;
+    }
+
+    // Engine::Scalar and Engine::Simd on CPUs without SIMD support
+    for (; done < n; ++done) {
+        out[done] = decrypt ? this->decrypt(in[done]) : encrypt(in[done]);
+    }
+}
+
+namespace {
+
+// Adds the time since the previous lap to one counter of a CountProfile; a
+// null profile makes every lap a single branch
+class PhaseTimer {
+public:
+    explicit PhaseTimer(Present::CountProfile* profile) : profile_(profile), last_(profile ? now() : 0) {}
+
+    void lap(uint64_t Present::CountProfile::*counter)
+    {
+        if (profile_) {
+            const uint64_t t = now();
+            profile_->*counter += t - last_;
+            last_ = t;
+        }
+    }
+
+private:
+    static uint64_t now()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    Present::CountProfile* profile_;
+    uint64_t last_;
+};
+
+} // namespace
+
+uint64_t Present::countDifferential(uint64_t alpha, uint64_t beta, uint64_t n, Rng& rng,
+                                    Engine engine, CountProfile* profile) const
+{
+    if (!keySet_) {
+        throw std::runtime_error("Key has not been set. Call setKey() before encryption.");
+    }
+
+    const size_t batch = 1024;
+    std::vector<uint64_t> buffer(2 * batch);
+    uint64_t hits = 0;
+    PhaseTimer timer(profile);
+
+    // Same engine choice as encryptBlocks(): everything except the bitsliced
+    // engine encrypts both halves of the pairs in one batch.
+    const present_detail::SimdLevel level = present_detail::simdLevel();
+    const bool bitsliced = engine == Engine::Bitsliced ||
+        (engine == Engine::Auto && level < present_detail::SimdLevel::Avx2);
+
+    if (bitsliced) {
+        const size_t width = present_detail::BITSLICE_WIDTH;
+        std::vector<uint64_t> keyPlanes(static_cast<size_t>(rounds_ + 1) * 64);
+        present_detail::expandKeyPlanes(roundKeys_.data(), rounds_, keyPlanes.data());
+        for (uint64_t done = 0; done < n; done += batch) {
+            const size_t count = static_cast<size_t>(n - done < batch ? n - done : batch);
+            rng.fillPlaintexts(buffer.data(), count);
+            timer.lap(&CountProfile::rngNanos);
+            for (size_t i = 0; i < count; i += width) {
+                int lanes = static_cast<int>(count - i < width ? count - i : width);
+                hits += present_detail::bitslicedCountDifferential(buffer.data() + i, lanes, alpha, beta,
+                                                                   keyPlanes.data(), rounds_);
+            }
+            timer.lap(&CountProfile::encryptNanos);
+        }
+        return hits;
+    }
+
+    uint64_t* first = buffer.data();
+    uint64_t* second = buffer.data() + batch;
+    for (uint64_t done = 0; done < n; done += batch) {
+        const size_t count = static_cast<size_t>(n - done < batch ? n - done : batch);
+        rng.fillPlaintexts(first, count);
+        for (size_t i = 0; i < count; ++i) {
+            second[i] = first[i] ^ alpha;
+        }
+        timer.lap(&CountProfile::rngNanos);
+        if (count == batch) {
+            encryptBlocks(buffer.data(), buffer.data(), 2 * batch, engine);
+        } else {
+            encryptBlocks(first, first, count, engine);
+            encryptBlocks(second, second, count, engine);
+        }
+        timer.lap(&CountProfile::encryptNanos);
+        for (size_t i = 0; i < count; ++i) {
+            hits += (first[i] ^ second[i]) == beta;
+        }
+        timer.lap(&CountProfile::compareNanos);
+    }
+    return hits;
+}
+
+uint64_t Present::countDifferential(uint64_t alpha, uint64_t beta, uint64_t n, uint64_t seed,
+                                    Engine engine) const
+{
+    SplitMixRng rng(seed);
+    return countDifferential(alpha, beta, n, rng, engine);
+}
+
+void Present::countDifferentialRounds(uint64_t alpha, const uint64_t* betas, uint64_t n, Rng& rng,
+                                      uint64_t* hits, Engine engine, CountProfile* profile) const
+{
+    if (!keySet_) {
+        throw std::runtime_error("Key has not been set. Call setKey() before encryption.");
+    }
+
+    std::fill(hits, hits + rounds_, 0);
+    const size_t batch = 1024;
+    std::vector<uint64_t> buffer(2 * batch);
+    PhaseTimer timer(profile);
+
+    // Every round runs as a one-round cipher whose final round key is zero,
+    // so the engines leave the exact state after each round: round r uses
+    // stepKeys[2r] = roundKey(r) and stepKeys[2r + 1] = 0.
+    std::vector<uint64_t> stepKeys(2 * static_cast<size_t>(rounds_), 0);
+    for (int r = 0; r < rounds_; ++r) {
+        stepKeys[2 * r] = roundKeys_[r];
+    }
+
+    // Same engine choice as countDifferential()
+    const present_detail::SimdLevel level = present_detail::simdLevel();
+    const bool bitsliced = engine == Engine::Bitsliced ||
+        (engine == Engine::Auto && level < present_detail::SimdLevel::Avx2);
+
+    if (bitsliced) {
+        const size_t width = present_detail::BITSLICE_WIDTH;
+        std::vector<uint64_t> keyPlanes(stepKeys.size() * 64);
+        present_detail::expandKeyPlanes(stepKeys.data(), 2 * rounds_ - 1, keyPlanes.data());
+        for (uint64_t done = 0; done < n; done += batch) {
+            const size_t count = static_cast<size_t>(n - done < batch ? n - done : batch);
+            rng.fillPlaintexts(buffer.data(), count);
+            timer.lap(&CountProfile::rngNanos);
+            for (size_t i = 0; i < count; i += width) {
+                int lanes = static_cast<int>(count - i < width ? count - i : width);
+                present_detail::bitslicedCountDifferentialRounds(buffer.data() + i, lanes, alpha, betas,
+                                                                 keyPlanes.data(), rounds_, hits);
+            }
+            timer.lap(&CountProfile::encryptNanos);
+        }
+        return;
+    }
+
+    const bool simd = (engine == Engine::Simd || engine == Engine::Auto) &&
+        level != present_detail::SimdLevel::None;
+    uint64_t* first = buffer.data();
+    uint64_t* second = buffer.data() + batch;
+    for (uint64_t done = 0; done < n; done += batch) {
+        const size_t count = static_cast<size_t>(n - done < batch ? n - done : batch);
+        rng.fillPlaintexts(first, count);
+        for (size_t i = 0; i < count; ++i) {
+            second[i] = first[i] ^ alpha;
+        }
+        timer.lap(&CountProfile::rngNanos);
+        for (int r = 0; r < rounds_; ++r) {
+            const uint64_t* keys = stepKeys.data() + 2 * r;
+            for (uint64_t* half : {first, second}) {
+                if (simd) {
+                    present_detail::simdEncryptBlocks(half, half, count, keys, 1);
+                } else if (engine == Engine::Table) {
+                    present_detail::tableEncryptBlocks(half, half, count, keys, 1);
+                } else {
+                    for (size_t i = 0; i < count; ++i) {
+                        half[i] = applyPermutationLayer(applySubstitutionLayer(addRoundKey(half[i], keys[0])));
+                    }
+                }
+            }
+            timer.lap(&CountProfile::encryptNanos);
+            uint64_t matches = 0;
+            for (size_t i = 0; i < count; ++i) {
+                matches += (first[i] ^ second[i]) == betas[r];
+            }
+            hits[r] += matches;
+            timer.lap(&CountProfile::compareNanos);
+        }
+    }
+}
+
+void Present::countDifferentialRounds(uint64_t alpha, const uint64_t* betas, uint64_t n, uint64_t seed,
+                                      uint64_t* hits, Engine engine) const
+{
+    SplitMixRng rng(seed);
+    countDifferentialRounds(alpha, betas, n, rng, hits, engine);
+}
+
+uint64_t Present::countLinear(uint64_t inMask, uint64_t outMask, uint64_t n, Rng& rng,
+                              Engine engine) const
+{
+    if (!keySet_) {
+        throw std::runtime_error("Key has not been set. Call setKey() before encryption.");
+    }
+
+    const size_t batch = 1024;
+    std::vector<uint64_t> plaintexts(batch);
+    uint64_t holds = 0;
+
+    // Same engine choice as countDifferential()
+    const present_detail::SimdLevel level = present_detail::simdLevel();
+    const bool bitsliced = engine == Engine::Bitsliced ||
+        (engine == Engine::Auto && level < present_detail::SimdLevel::Avx2);
+
+    if (bitsliced) {
+        const size_t width = present_detail::BITSLICE_WIDTH;
+        std::vector<uint64_t> keyPlanes(static_cast<size_t>(rounds_ + 1) * 64);
+        present_detail::expandKeyPlanes(roundKeys_.data(), rounds_, keyPlanes.data());
+        for (uint64_t done = 0; done < n; done += batch) {
+            const size_t count = static_cast<size_t>(n - done < batch ? n - done : batch);
+            rng.fillPlaintexts(plaintexts.data(), count);
+            for (size_t i = 0; i < count; i += width) {
+                int lanes = static_cast<int>(count - i < width ? count - i : width);
+                holds += present_detail::bitslicedCountLinear(plaintexts.data() + i, lanes, inMask, outMask,
+                                                              keyPlanes.data(), rounds_);
+            }
+        }
+        return holds;
+    }
+
+    std::vector<uint64_t> ciphertexts(batch);
+    for (uint64_t done = 0; done < n; done += batch) {
+        const size_t count = static_cast<size_t>(n - done < batch ? n - done : batch);
+        rng.fillPlaintexts(plaintexts.data(), count);
+        encryptBlocks(plaintexts.data(), ciphertexts.data(), count, engine);
+        for (size_t i = 0; i < count; ++i) {
+            holds += !__builtin_parityll((plaintexts[i] & inMask) ^ (ciphertexts[i] & outMask));
+        }
+    }
+    return holds;
+}
+
+uint64_t Present::countLinear(uint64_t inMask, uint64_t outMask, uint64_t n, uint64_t seed,
+                              Engine engine) const
+{
+    SplitMixRng rng(seed);
+    return countLinear(inMask, outMask, n, rng, engine);
+}
+
+const char* Present::permutationLayerImpl()
+{
+    return present_detail::permutationLayer().name;
+}
+
+const char* Present::simdInstructionSet()
+{
+    return present_detail::simdLevelName(present_detail::simdLevel());
+}
+
 std::vector<uint8_t> Present::generateRandomKey()
 {
     size_t keyLengthBytes = static_cast<size_t>(keySize_) / 8;
@@ -75,28 +498,39 @@ uint64_t Present::generateRandomPlaintext()
     return distrib(gen_);
 }
 
+std::vector<uint8_t> Present::generateRandomKey(Rng& rng) const
+{
+    std::vector<uint8_t> key(static_cast<size_t>(keySize_) / 8);
+    rng.fillBytes(key.data(), key.size());
+    return key;
+}
+
+uint64_t Present::generateRandomPlaintext(Rng& rng)
+{
+    return rng.next();
+}
+
 uint64_t Present::applySubstitutionLayer(uint64_t state) const
 {
-    uint64_t substituted_state = 0;
-    for (int i = 0; i < 16; ++i) { // 64 bits / 4 bits per nibble = 16 nibbles
-        // Extract the i-th nibble (from right to left, i=0 is LSB nibble)
-        uint8_t nibble = (state >> (i * 4)) & 0x0F;
-        // Apply S-box
-        uint8_t substituted_nibble = SBOX[nibble];
-        // Place the substituted nibble back into the result
-        substituted_state |= (static_cast<uint64_t>(substituted_nibble) << (i * 4));
-    }
-    return substituted_state;
+    // Byte-wise lookups in the S-box table shared with PresentT
+    return present_detail::sBoxLayer(state);
 }
 
 uint64_t Present::applyPermutationLayer(uint64_t state) const
 {
-    uint64_t new_state = _pext_u64(state, 0x1111111111111111)
-    | (_pext_u64(state, 0x2222222222222222) << 16)
-    | (_pext_u64(state, 0x4444444444444444) << 32)
-    | (_pext_u64(state, 0x8888888888888888) << 48);
+    // PEXT, shift/mask network or table, whichever was fastest on this CPU
+    return permutationLayer_(state);
+}
+
+uint64_t Present::applyInverseSubstitutionLayer(uint64_t state) const
+{
+    return present_detail::invSBoxLayer(state);
+}
 
-    return new_state;
+uint64_t Present::applyInversePermutationLayer(uint64_t state) const
+{
+    // Inverse of whichever implementation applyPermutationLayer() uses
+    return inversePermutationLayer_(state);
 }
 
 uint64_t Present::addRoundKey(uint64_t state, uint64_t roundKey) const
@@ -106,104 +540,19 @@ uint64_t Present::addRoundKey(uint64_t state, uint64_t roundKey) const
 
 void Present::generateRoundKeys(const uint8_t* masterKey)
 {
-    // Get key size parameters
-    int keyLenBits = static_cast<int>(keySize_);
-    int keyLenBytes = keyLenBits / 8;
-    
-    // Create a bitset to hold the key register
-    std::bitset<128> key_register; // 128 bits is enough for both 80-bit and 128-bit keys
-    
-    // Load the master key into the bitset (MSB first)
-    for (int i = 0; i < keyLenBytes; ++i) {
-        for (int j = 0; j < 8; ++j) {
-            if (masterKey[i] & (1 << (7 - j))) {
-                key_register.set(i * 8 + j);
-            }
-        }
-    }
-    
-    // Extract round key function (gets the leftmost 64 bits)
-    auto extract_round_key = [&key_register, &keyLenBits]() -> uint64_t {
-        uint64_t rk = 0;
-        for (int i = 0; i < 64; ++i) {
-            if (key_register[keyLenBits - 1 - i]) {
-                rk |= (1ULL << (63 - i));
-            }
-        }
-        
-        return rk;
-    };
-    
-    // Process each round
+    int keyLenBytes = static_cast<int>(keySize_) / 8;
+
+    // The key register is held in two words, bit p of the register being bit p
+    // of (hi:lo).
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+    present_detail::loadKeyRegister(masterKey, keyLenBytes, lo, hi);
+
+    const int keyBits = static_cast<int>(keySize_);
     for (int round_idx = 0; round_idx < rounds_ + 1; ++round_idx) {
-        // 1. Extract the round key
-        roundKeys_[round_idx] = extract_round_key();
-        
-        
-        // 2. Rotate key register left by 61 bits
-        // Create a temporary bitset for rotation
-        std::bitset<128> rotated;
-        for (int i = 0; i < keyLenBits; ++i) {
-            int new_pos = (i + 61) % keyLenBits;
-            rotated[new_pos] = key_register[i];
-        }
-        key_register = rotated;
-        
-        // 3. Apply S-box
-        if (keySize_ == KeySize::KEY_80) {
-            // Apply S-box to leftmost 4 bits (bits 79-76)
-            uint8_t nibble = 0;
-            for (int i = 0; i < 4; ++i) {
-                if (key_register[keyLenBits - 1 - i]) {
-                    nibble |= (1 << (3 - i));
-                }
-            }
-            
-            uint8_t sbox_result = SBOX[nibble];
-            
-            // Replace the nibble with S-box output
-            for (int i = 0; i < 4; ++i) {
-                key_register[keyLenBits - 1 - i] = (sbox_result >> (3 - i)) & 1;
-            }
-        } 
-        else { // KEY_128
-            // Apply S-box to leftmost 8 bits (bits 127-120)
-            uint8_t byte_val = 0;
-            for (int i = 0; i < 8; ++i) {
-                if (key_register[keyLenBits - 1 - i]) {
-                    byte_val |= (1 << (7 - i));
-                }
-            }
-            
-            // Split byte into nibbles and apply S-box
-            uint8_t nibble1 = (byte_val >> 4) & 0x0F;
-            uint8_t nibble2 = byte_val & 0x0F;
-            uint8_t sbox_result = (SBOX[nibble1] << 4) | SBOX[nibble2];
-            
-            // Replace the byte with S-box output
-            for (int i = 0; i < 8; ++i) {
-                key_register[keyLenBits - 1 - i] = (sbox_result >> (7 - i)) & 1;
-            }
-        }
-        
-        // 4. XOR round counter with bits k_19 ... k_15
-        uint8_t round_c_val = static_cast<uint8_t>(round_idx + 1);
-        
-        for (int j = 15; j <= 19; ++j) {
-            bool rc_bit = (round_c_val >> (j - 15)) & 1;
-            if (rc_bit) { // Only XOR if rc_bit is 1
-                // Flip the bit at position j
-                key_register.flip(j);
-            }
-        }
-    }
-    
-    #ifdef DEBUG
-    std::cout << "Round keys:" << std::endl;
-    for (const auto& rk : roundKeys_) {
-        std::cout << std::hex << std::setw(16) << std::setfill('0') << rk << std::endl;
+        roundKeys_[round_idx] = present_detail::registerRoundKey(keyBits, lo, hi);
+        present_detail::updateKeyRegister(keyBits, lo, hi, round_idx);
     }
-    #endif
 }
 
 // Initialize static members
@@ -211,4 +560,5 @@ std::random_device Present::rd_;
 std::mt19937_64 Present::gen_(Present::rd_());
 
 // Definition for the static constexpr SBOX
-constexpr uint8_t Present::SBOX[16];
\ No newline at end of file
+constexpr uint8_t Present::SBOX[16];
+constexpr uint8_t Present::INV_SBOX[16];
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include <cstring>
+#include "present_bitslice.hh"
+#include "present_player.hh"
+
+namespace present_detail {
+
+namespace {
+
+// Substitutes nibble `nibble` and writes the outputs to the planes that pLayer
+// moves them to.
+inline void sboxPermuteNibble(const uint64_t* in, uint64_t* out, int nibble)
+{
+    uint64_t y0, y1, y2, y3;
+    bitslicedSbox(in[4 * nibble + 0], in[4 * nibble + 1], in[4 * nibble + 2], in[4 * nibble + 3],
+                  y0, y1, y2, y3);
+
+    out[permutedBit(4 * nibble + 0)] = y0;
+    out[permutedBit(4 * nibble + 1)] = y1;
+    out[permutedBit(4 * nibble + 2)] = y2;
+    out[permutedBit(4 * nibble + 3)] = y3;
+}
+
+// Gathers nibble `nibble` from the planes pLayer moved it to, undoes the
+// S-box and writes it back in place: the inverse round in one step.
+inline void unpermuteInvSboxNibble(const uint64_t* in, uint64_t* out, int nibble)
+{
+    bitslicedInvSbox(in[permutedBit(4 * nibble + 0)], in[permutedBit(4 * nibble + 1)],
+                     in[permutedBit(4 * nibble + 2)], in[permutedBit(4 * nibble + 3)],
+                     out[4 * nibble + 0], out[4 * nibble + 1], out[4 * nibble + 2], out[4 * nibble + 3]);
+}
+
+} // namespace
+
+void transpose64(uint64_t a[64])
+{
+    uint64_t m = 0x00000000FFFFFFFFULL;
+    for (int j = 32; j != 0; j >>= 1, m ^= (m << j)) {
+        for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            uint64_t t = ((a[k] >> j) ^ a[k | j]) & m;
+            a[k] ^= t << j;
+            a[k | j] ^= t;
+        }
+    }
+}
+
+void expandKeyPlanes(const uint64_t* roundKeys, int rounds, uint64_t* keyPlanes)
+{
+    for (int r = 0; r <= rounds; ++r) {
+        for (int j = 0; j < 64; ++j) {
+            keyPlanes[r * 64 + j] = 0 - ((roundKeys[r] >> j) & 1);
+        }
+    }
+}
+
+void bitslicedEncrypt(uint64_t planes[64], const uint64_t* keyPlanes, int rounds)
+{
+    uint64_t tmp[64];
+
+    for (int r = 0; r < rounds; ++r) {
+        const uint64_t* rk = keyPlanes + r * 64;
+        for (int j = 0; j < 64; ++j) {
+            planes[j] ^= rk[j];
+        }
+        // pLayer costs nothing: the S-box outputs are stored straight into their
+        // permuted planes.
+        for (int i = 0; i < 16; ++i) {
+            sboxPermuteNibble(planes, tmp, i);
+        }
+        std::memcpy(planes, tmp, sizeof(tmp));
+    }
+
+    const uint64_t* rk = keyPlanes + rounds * 64;
+    for (int j = 0; j < 64; ++j) {
+        planes[j] ^= rk[j];
+    }
+}
+
+void bitslicedEncryptBlocks(const uint64_t* in, uint64_t* out, int n,
+                            const uint64_t* keyPlanes, int rounds)
+{
+    uint64_t planes[BITSLICE_WIDTH] = {0};
+    std::memcpy(planes, in, n * sizeof(uint64_t));
+
+    transpose64(planes);
+    bitslicedEncrypt(planes, keyPlanes, rounds);
+    transpose64(planes);
+
+    std::memcpy(out, planes, n * sizeof(uint64_t));
+}
+
+void bitslicedDecrypt(uint64_t planes[64], const uint64_t* keyPlanes, int rounds)
+{
+    uint64_t tmp[64];
+
+    const uint64_t* last = keyPlanes + rounds * 64;
+    for (int j = 0; j < 64; ++j) {
+        planes[j] ^= last[j];
+    }
+
+    for (int r = rounds - 1; r >= 0; --r) {
+        for (int i = 0; i < 16; ++i) {
+            unpermuteInvSboxNibble(planes, tmp, i);
+        }
+        const uint64_t* rk = keyPlanes + r * 64;
+        for (int j = 0; j < 64; ++j) {
+            planes[j] = tmp[j] ^ rk[j];
+        }
+    }
+}
+
+void bitslicedDecryptBlocks(const uint64_t* in, uint64_t* out, int n,
+                            const uint64_t* keyPlanes, int rounds)
+{
+    uint64_t planes[BITSLICE_WIDTH] = {0};
+    std::memcpy(planes, in, n * sizeof(uint64_t));
+
+    transpose64(planes);
+    bitslicedDecrypt(planes, keyPlanes, rounds);
+    transpose64(planes);
+
+    std::memcpy(out, planes, n * sizeof(uint64_t));
+}
+
+int bitslicedCountDifferential(const uint64_t* in, int n, uint64_t alpha, uint64_t beta,
+                               const uint64_t* keyPlanes, int rounds)
+{
+    uint64_t first[BITSLICE_WIDTH] = {0};
+    uint64_t second[BITSLICE_WIDTH];
+    std::memcpy(first, in, n * sizeof(uint64_t));
+
+    // In plane form flipping input bit j of every lane complements plane j
+    transpose64(first);
+    for (int j = 0; j < 64; ++j) {
+        second[j] = first[j] ^ (0 - ((alpha >> j) & 1));
+    }
+    bitslicedEncrypt(first, keyPlanes, rounds);
+    bitslicedEncrypt(second, keyPlanes, rounds);
+
+    // A lane survives while every bit of its output difference matches beta
+    uint64_t match = (n == BITSLICE_WIDTH) ? ~0ULL : (1ULL << n) - 1;
+    for (int j = 0; j < 64; ++j) {
+        match &= ~(first[j] ^ second[j] ^ (0 - ((beta >> j) & 1)));
+    }
+    return __builtin_popcountll(match);
+}
+
+void bitslicedCountDifferentialRounds(const uint64_t* in, int n, uint64_t alpha, const uint64_t* betas,
+                                      const uint64_t* keyPlanes, int rounds, uint64_t* hits)
+{
+    uint64_t first[BITSLICE_WIDTH] = {0};
+    uint64_t second[BITSLICE_WIDTH];
+    std::memcpy(first, in, n * sizeof(uint64_t));
+
+    transpose64(first);
+    for (int j = 0; j < 64; ++j) {
+        second[j] = first[j] ^ (0 - ((alpha >> j) & 1));
+    }
+
+    const uint64_t lanes = (n == BITSLICE_WIDTH) ? ~0ULL : (1ULL << n) - 1;
+    for (int r = 0; r < rounds; ++r) {
+        bitslicedEncrypt(first, keyPlanes + 2 * r * 64, 1);
+        bitslicedEncrypt(second, keyPlanes + 2 * r * 64, 1);
+        uint64_t match = lanes;
+        for (int j = 0; j < 64; ++j) {
+            match &= ~(first[j] ^ second[j] ^ (0 - ((betas[r] >> j) & 1)));
+        }
+        hits[r] += __builtin_popcountll(match);
+    }
+}
+
+int bitslicedCountLinear(const uint64_t* in, int n, uint64_t inMask, uint64_t outMask,
+                         const uint64_t* keyPlanes, int rounds)
+{
+    uint64_t planes[BITSLICE_WIDTH] = {0};
+    std::memcpy(planes, in, n * sizeof(uint64_t));
+
+    transpose64(planes);
+    uint64_t parity = 0;
+    for (uint64_t m = inMask; m != 0; m &= m - 1) {
+        parity ^= planes[__builtin_ctzll(m)];
+    }
+    bitslicedEncrypt(planes, keyPlanes, rounds);
+    for (uint64_t m = outMask; m != 0; m &= m - 1) {
+        parity ^= planes[__builtin_ctzll(m)];
+    }
+
+    const uint64_t lanes = (n == BITSLICE_WIDTH) ? ~0ULL : (1ULL << n) - 1;
+    return __builtin_popcountll(~parity & lanes);
+}
+
+} // namespace present_detail
@@ -0,0 +1,197 @@
+/*
+ * File: present_bitslice.hh
+ *
+ * Description:    Internal bitsliced PRESENT kernel
+ *
+ * The bitsliced engine processes 64 blocks at once. The blocks are transposed
+ * into 64 bit-planes (plane j holds bit j of every block, block b in bit b of
+ * each plane), the S-box is evaluated as a Boolean circuit on four planes at a
+ * time and pLayer becomes a renaming of planes.
+ *
+ * Copyright (c) 2025 Ahmet Çobanoğlu
+ * All rights reserved.
+ *
+ * This file is proprietary and confidential. Unauthorized copying, distribution,
+ * modification, or use of this file, via any medium, is strictly prohibited
+ * without express written permission from the copyright holder.
+ */
+
+#ifndef C309144A_E5F7_4592_9FFD_BBAD98C682FF
+#define C309144A_E5F7_4592_9FFD_BBAD98C682FF
+
+#include <cstdint>
+
+namespace present_detail {
+
+/**
+ * @brief Number of blocks processed by one bitsliced batch
+ */
+constexpr int BITSLICE_WIDTH = 64;
+
+/**
+ * @brief PRESENT S-box as a 14-gate Boolean circuit on four bit-planes
+ *
+ * b0 and y0 are the least significant bits of the input and output nibbles.
+ */
+inline void bitslicedSbox(uint64_t b0, uint64_t b1, uint64_t b2, uint64_t b3,
+                          uint64_t& y0, uint64_t& y1, uint64_t& y2, uint64_t& y3)
+{
+    uint64_t t1 = b1 ^ b2;
+    uint64_t t2 = b2 & t1;
+    const uint64_t t3 = b3 ^ t2;
+    y0 = b0 ^ t3;
+    t2 = t1 & t3;
+    t1 ^= y0;
+    t2 ^= b2;
+    const uint64_t t4 = b0 | t2;
+    y1 = t1 ^ t4;
+    t2 ^= ~b0;
+    y3 = y1 ^ t2;
+    t2 |= t1;
+    y2 = t3 ^ t2;
+}
+
+/**
+ * @brief Inverse PRESENT S-box as a Boolean circuit on four bit-planes
+ *
+ * Derived from the algebraic normal form of the inverse S-box, with the
+ * products shared between output bits.
+ */
+inline void bitslicedInvSbox(uint64_t b0, uint64_t b1, uint64_t b2, uint64_t b3,
+                             uint64_t& y0, uint64_t& y1, uint64_t& y2, uint64_t& y3)
+{
+    const uint64_t t13 = b1 & b3;
+    const uint64_t t12 = b1 & b2;
+    const uint64_t b13 = b1 ^ b3;
+    const uint64_t u = b2 & b13;  // b1b2 ^ b2b3
+    const uint64_t t23 = u ^ t12;
+    const uint64_t b123 = b13 ^ b2;
+    y0 = ~(b0 ^ b2 ^ t13);
+    y1 = (b1 | b3) ^ t23 ^ (b0 & ~(b2 ^ u ^ t13));
+    y2 = ~(t12 ^ b3 ^ t13) ^ (b0 & (b123 ^ u ^ t13));
+    y3 = b123 ^ (b0 & ~(b1 ^ u));
+}
+
+/**
+ * @brief Transpose a 64x64 bit matrix in place
+ *
+ * Converts 64 blocks into 64 bit-planes and back (the operation is an involution).
+ *
+ * @param a 64 words, bit c of a[r] is swapped with bit r of a[c]
+ */
+void transpose64(uint64_t a[64]);
+
+/**
+ * @brief Expand round keys into bitsliced key planes
+ *
+ * Plane j of round r is all-ones if bit j of roundKeys[r] is set, zero otherwise.
+ *
+ * @param roundKeys rounds + 1 round keys
+ * @param rounds Number of rounds
+ * @param keyPlanes Output, (rounds + 1) * 64 words
+ */
+void expandKeyPlanes(const uint64_t* roundKeys, int rounds, uint64_t* keyPlanes);
+
+/**
+ * @brief Encrypt 64 blocks held as bit-planes
+ *
+ * Each lane may use its own key: keyPlanes holds (rounds + 1) * 64 words, either
+ * produced by expandKeyPlanes() or by a bitsliced key schedule.
+ *
+ * @param planes 64 bit-planes, updated in place
+ * @param keyPlanes Bitsliced round keys
+ * @param rounds Number of rounds
+ */
+void bitslicedEncrypt(uint64_t planes[64], const uint64_t* keyPlanes, int rounds);
+
+/**
+ * @brief Encrypt n blocks (n <= 64) with the bitsliced kernel
+ *
+ * @param in Input blocks
+ * @param out Output blocks (may alias in)
+ * @param n Number of blocks, at most BITSLICE_WIDTH
+ * @param keyPlanes Bitsliced round keys
+ * @param rounds Number of rounds
+ */
+void bitslicedEncryptBlocks(const uint64_t* in, uint64_t* out, int n,
+                            const uint64_t* keyPlanes, int rounds);
+
+/**
+ * @brief Decrypt 64 blocks held as bit-planes
+ *
+ * @param planes 64 bit-planes, updated in place
+ * @param keyPlanes Bitsliced round keys
+ * @param rounds Number of rounds
+ */
+void bitslicedDecrypt(uint64_t planes[64], const uint64_t* keyPlanes, int rounds);
+
+/**
+ * @brief Decrypt n blocks (n <= 64) with the bitsliced kernel
+ *
+ * @param in Input blocks
+ * @param out Output blocks (may alias in)
+ * @param n Number of blocks, at most BITSLICE_WIDTH
+ * @param keyPlanes Bitsliced round keys
+ * @param rounds Number of rounds
+ */
+void bitslicedDecryptBlocks(const uint64_t* in, uint64_t* out, int n,
+                            const uint64_t* keyPlanes, int rounds);
+
+/**
+ * @brief Count the right pairs among n plaintext pairs (p, p ^ alpha), n <= 64
+ *
+ * Both halves are encrypted as bit-planes and the output difference is
+ * compared with beta plane by plane, so the ciphertexts are never transposed
+ * back.
+ *
+ * @param in n first plaintexts of the pairs
+ * @param n Number of pairs, at most BITSLICE_WIDTH
+ * @param alpha Input difference
+ * @param beta Output difference
+ * @param keyPlanes Bitsliced round keys
+ * @param rounds Number of rounds
+ * @return int Number of pairs whose output difference equals beta
+ */
+int bitslicedCountDifferential(const uint64_t* in, int n, uint64_t alpha, uint64_t beta,
+                               const uint64_t* keyPlanes, int rounds);
+
+/**
+ * @brief Count right pairs after every round among n pairs (p, p ^ alpha), n <= 64
+ *
+ * The rounds are run one at a time as single-round bitslicedEncrypt() calls.
+ * keyPlanes holds the planes of 2 * rounds round keys, the key of round r
+ * followed by the zero key, so the planes hold the exact state after every
+ * round.
+ *
+ * @param in n first plaintexts of the pairs
+ * @param n Number of pairs, at most BITSLICE_WIDTH
+ * @param alpha Input difference
+ * @param betas rounds target differences, betas[r] for the state after r + 1 rounds
+ * @param keyPlanes Bitsliced round keys, 2 * rounds * 64 words
+ * @param rounds Number of rounds
+ * @param hits rounds counters, hits[r] is increased by the pairs matching betas[r]
+ */
+void bitslicedCountDifferentialRounds(const uint64_t* in, int n, uint64_t alpha, const uint64_t* betas,
+                                      const uint64_t* keyPlanes, int rounds, uint64_t* hits);
+
+/**
+ * @brief Count the plaintexts among n for which a linear approximation holds, n <= 64
+ *
+ * The parity of the masked bits of all lanes is the XOR of the selected
+ * bit-planes, so one popcount counts the lanes where input and output parity
+ * agree.
+ *
+ * @param in n plaintexts
+ * @param n Number of plaintexts, at most BITSLICE_WIDTH
+ * @param inMask Plaintext mask
+ * @param outMask Ciphertext mask
+ * @param keyPlanes Bitsliced round keys
+ * @param rounds Number of rounds
+ * @return int Number of plaintexts with parity(p & inMask) == parity(c & outMask)
+ */
+int bitslicedCountLinear(const uint64_t* in, int n, uint64_t inMask, uint64_t outMask,
+                         const uint64_t* keyPlanes, int rounds);
+
+} // namespace present_detail
+
+#endif /* C309144A_E5F7_4592_9FFD_BBAD98C682FF */
@@ -0,0 +1,146 @@
+#include <cstring>
+#include <stdexcept>
+#include "present_keybatch.hh"
+#include "present_bitslice.hh"
+#include "present_core.hh"
+
+namespace {
+
+// Bitsliced key schedule for up to 64 keys. Register bit p of every key lives in
+// plane (p + shift) mod n, so the 61-bit rotation only moves the offset.
+void bitslicedKeySchedule(const uint8_t* keys, size_t count, Present::KeySize keySize,
+                          int rounds, uint64_t* keyPlanes)
+{
+    const int n = static_cast<int>(keySize);
+    const int keyLenBytes = n / 8;
+
+    uint64_t lo[64] = {0};
+    uint64_t hi[64] = {0};
+    for (size_t lane = 0; lane < count; ++lane) {
+        present_detail::loadKeyRegister(keys + lane * keyLenBytes, keyLenBytes, lo[lane], hi[lane]);
+    }
+    present_detail::transpose64(lo);
+    present_detail::transpose64(hi);
+
+    uint64_t reg[128];
+    for (int p = 0; p < 64; ++p) {
+        reg[p] = lo[p];
+        reg[64 + p] = hi[p];
+    }
+
+    int shift = 0;
+    auto plane = [&reg, &shift, n](int p) -> uint64_t& {
+        int idx = p + shift;
+        return reg[idx >= n ? idx - n : idx];
+    };
+
+    for (int round_idx = 0; round_idx < rounds + 1; ++round_idx) {
+        // 1. Extract the round key (leftmost 64 bits)
+        // The 64 planes are contiguous in reg apart from one possible wrap-around.
+        uint64_t* rk = keyPlanes + round_idx * 64;
+        const int first = (n - 64 + shift) % n;
+        const int run = (n - first < 64) ? n - first : 64;
+        std::memcpy(rk, reg + first, run * sizeof(uint64_t));
+        std::memcpy(rk + run, reg, (64 - run) * sizeof(uint64_t));
+
+        // 2. Rotate left by 61 bits: new bit p is old bit p - 61
+        shift = (shift + n - 61) % n;
+
+        // 3. Apply S-box to the top nibble (and the one below it for 128-bit keys)
+        const int sboxes = (keySize == Present::KeySize::KEY_80) ? 1 : 2;
+        for (int s = 0; s < sboxes; ++s) {
+            const int base = n - 4 * (s + 1);
+            present_detail::bitslicedSbox(plane(base), plane(base + 1), plane(base + 2), plane(base + 3),
+                                          plane(base), plane(base + 1), plane(base + 2), plane(base + 3));
+        }
+
+        // 4. XOR round counter into bits k_19 ... k_15: complement those planes
+        const uint64_t counter = present_detail::roundCounter(round_idx);
+        for (int j = 15; j <= 19; ++j) {
+            if ((counter >> j) & 1) {
+                plane(j) = ~plane(j);
+            }
+        }
+    }
+}
+
+} // namespace
+
+PresentKeyBatch::PresentKeyBatch(Present::KeySize keySize, int rounds)
+    : keySize_(keySize), rounds_(rounds), numKeys_(0)
+{
+}
+
+void PresentKeyBatch::setKeys(const uint8_t* keys, size_t numKeys)
+{
+    const size_t keyLenBytes = static_cast<size_t>(keySize_) / 8;
+    const size_t width = present_detail::BITSLICE_WIDTH;
+    const size_t groups = (numKeys + width - 1) / width;
+    const size_t groupPlanes = static_cast<size_t>(rounds_ + 1) * 64;
+
+    keyPlanes_.resize(groups * groupPlanes);
+    for (size_t g = 0; g < groups; ++g) {
+        size_t count = numKeys - g * width < width ? numKeys - g * width : width;
+        bitslicedKeySchedule(keys + g * width * keyLenBytes, count, keySize_, rounds_,
+                             keyPlanes_.data() + g * groupPlanes);
+    }
+    numKeys_ = numKeys;
+}
+
+const uint64_t* PresentKeyBatch::groupKeyPlanes(size_t group) const
+{
+    return keyPlanes_.data() + group * static_cast<size_t>(rounds_ + 1) * 64;
+}
+
+void PresentKeyBatch::encrypt(uint64_t plaintext, uint64_t* out) const
+{
+    encryptBlocks(&plaintext, 1, out);
+}
+
+void PresentKeyBatch::encryptBlocks(const uint64_t* plaintexts, size_t numPlaintexts, uint64_t* out) const
+{
+    if (numKeys_ == 0) {
+        throw std::runtime_error("No keys have been set. Call setKeys() before encryption.");
+    }
+
+    const size_t width = present_detail::BITSLICE_WIDTH;
+    const size_t groups = (numKeys_ + width - 1) / width;
+
+    for (size_t p = 0; p < numPlaintexts; ++p) {
+        // Every lane encrypts the same plaintext: broadcast each bit to a plane
+        uint64_t broadcast[64];
+        for (int j = 0; j < 64; ++j) {
+            broadcast[j] = 0 - ((plaintexts[p] >> j) & 1);
+        }
+
+        for (size_t g = 0; g < groups; ++g) {
+            uint64_t planes[64];
+            for (int j = 0; j < 64; ++j) {
+                planes[j] = broadcast[j];
+            }
+            present_detail::bitslicedEncrypt(planes, groupKeyPlanes(g), rounds_);
+            present_detail::transpose64(planes);
+
+            size_t count = numKeys_ - g * width < width ? numKeys_ - g * width : width;
+            uint64_t* dst = out + p * numKeys_ + g * width;
+            for (size_t lane = 0; lane < count; ++lane) {
+                dst[lane] = planes[lane];
+            }
+        }
+    }
+}
+
+uint64_t PresentKeyBatch::roundKey(size_t keyIndex, int round) const
+{
+    if (keyIndex >= numKeys_ || round < 0 || round > rounds_) {
+        throw std::out_of_range("Key index or round out of range.");
+    }
+
+    const uint64_t* rk = groupKeyPlanes(keyIndex / present_detail::BITSLICE_WIDTH) + round * 64;
+    const int lane = static_cast<int>(keyIndex % present_detail::BITSLICE_WIDTH);
+    uint64_t value = 0;
+    for (int j = 0; j < 64; ++j) {
+        value |= ((rk[j] >> lane) & 1) << j;
+    }
+    return value;
+}
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include "present_modes.hh"
+
+namespace present_modes {
+
+namespace {
+
+// Blocks converted per engine call: large enough for the SIMD and bitsliced
+// engines to run full groups, small enough to stay in L1
+constexpr size_t RUN_BLOCKS = 512;
+
+template <bool Decrypt>
+void ecbProcess(const Present& cipher, const uint8_t* in, uint8_t* out, size_t numBlocks)
+{
+    uint64_t buf[RUN_BLOCKS];
+    for (size_t done = 0; done < numBlocks; done += RUN_BLOCKS) {
+        const size_t count = std::min(RUN_BLOCKS, numBlocks - done);
+        const uint8_t* src = in + done * BLOCK_BYTES;
+        uint8_t* dst = out + done * BLOCK_BYTES;
+        for (size_t i = 0; i < count; ++i) {
+            buf[i] = loadBlock(src + i * BLOCK_BYTES);
+        }
+        if (Decrypt) {
+            cipher.decryptBlocks(buf, buf, count);
+        } else {
+            cipher.encryptBlocks(buf, buf, count);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            storeBlock(buf[i], dst + i * BLOCK_BYTES);
+        }
+    }
+}
+
+} // namespace
+
+void ecbEncrypt(const Present& cipher, const uint8_t* in, uint8_t* out, size_t numBlocks)
+{
+    ecbProcess<false>(cipher, in, out, numBlocks);
+}
+
+void ecbDecrypt(const Present& cipher, const uint8_t* in, uint8_t* out, size_t numBlocks)
+{
+    ecbProcess<true>(cipher, in, out, numBlocks);
+}
+
+uint64_t cbcEncrypt(const Present& cipher, uint64_t iv, const uint8_t* in, uint8_t* out, size_t numBlocks)
+{
+    uint64_t chain = iv;
+    for (size_t i = 0; i < numBlocks; ++i) {
+        chain = cipher.encrypt(loadBlock(in + i * BLOCK_BYTES) ^ chain);
+        storeBlock(chain, out + i * BLOCK_BYTES);
+    }
+    return chain;
+}
+
+uint64_t cbcDecrypt(const Present& cipher, uint64_t iv, const uint8_t* in, uint8_t* out, size_t numBlocks)
+{
+    uint64_t cipherBuf[RUN_BLOCKS];
+    uint64_t plainBuf[RUN_BLOCKS];
+    uint64_t chain = iv;
+    for (size_t done = 0; done < numBlocks; done += RUN_BLOCKS) {
+        const size_t count = std::min(RUN_BLOCKS, numBlocks - done);
+        const uint8_t* src = in + done * BLOCK_BYTES;
+        uint8_t* dst = out + done * BLOCK_BYTES;
+        // Load the whole run first: with in == out the stores below would
+        // otherwise overwrite ciphertext still needed for chaining
+        for (size_t i = 0; i < count; ++i) {
+            cipherBuf[i] = loadBlock(src + i * BLOCK_BYTES);
+        }
+        cipher.decryptBlocks(cipherBuf, plainBuf, count);
+        for (size_t i = 0; i < count; ++i) {
+            storeBlock(plainBuf[i] ^ chain, dst + i * BLOCK_BYTES);
+            chain = cipherBuf[i];
+        }
+    }
+    return chain;
+}
+
+void ctrCrypt(const Present& cipher, uint64_t iv, uint64_t offset,
+              const uint8_t* in, uint8_t* out, size_t numBytes)
+{
+    uint64_t keystream[RUN_BLOCKS];
+    uint64_t block = offset / BLOCK_BYTES;
+    size_t skip = static_cast<size_t>(offset % BLOCK_BYTES); // Bytes of the first block already used
+    size_t done = 0;
+
+    while (done < numBytes) {
+        const size_t wanted = (numBytes - done + skip + BLOCK_BYTES - 1) / BLOCK_BYTES;
+        const size_t count = std::min(RUN_BLOCKS, wanted);
+        for (size_t i = 0; i < count; ++i) {
+            keystream[i] = iv + block + i;
+        }
+        cipher.encryptBlocks(keystream, keystream, count);
+
+        uint8_t bytes[RUN_BLOCKS * BLOCK_BYTES];
+        for (size_t i = 0; i < count; ++i) {
+            storeBlock(keystream[i], bytes + i * BLOCK_BYTES);
+        }
+        const size_t avail = std::min(count * BLOCK_BYTES - skip, numBytes - done);
+        for (size_t i = 0; i < avail; ++i) {
+            out[done + i] = in[done + i] ^ bytes[skip + i];
+        }
+
+        done += avail;
+        block += count;
+        skip = 0;
+    }
+}
+
+} // namespace present_modes
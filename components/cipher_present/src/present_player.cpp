@@ -0,0 +1,158 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include "present_player.hh"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h> // For _pext_u64, _pdep_u64
+#define PRESENT_PLAYER_PEXT 1
+#endif
+
+namespace present_detail {
+
+namespace {
+
+struct PermutationTables {
+    uint64_t t[8][256];
+};
+
+constexpr PermutationTables makePermutationTables(bool inverse)
+{
+    PermutationTables tables = {};
+    for (int j = 0; j < 8; ++j) {
+        for (int b = 0; b < 256; ++b) {
+            uint64_t permuted = 0;
+            for (int bit = 0; bit < 8; ++bit) {
+                if ((b >> bit) & 1) {
+                    const int i = 8 * j + bit;
+                    permuted |= 1ULL << (inverse ? inversePermutedBit(i) : permutedBit(i));
+                }
+            }
+            tables.t[j][b] = permuted;
+        }
+    }
+    return tables;
+}
+
+alignas(64) constexpr PermutationTables PERMUTATION_TABLES = makePermutationTables(false);
+alignas(64) constexpr PermutationTables INVERSE_PERMUTATION_TABLES = makePermutationTables(true);
+
+inline uint64_t permuteByTables(const PermutationTables& tables, uint64_t x)
+{
+    return tables.t[0][x & 0xFF] ^
+           tables.t[1][(x >> 8) & 0xFF] ^
+           tables.t[2][(x >> 16) & 0xFF] ^
+           tables.t[3][(x >> 24) & 0xFF] ^
+           tables.t[4][(x >> 32) & 0xFF] ^
+           tables.t[5][(x >> 40) & 0xFF] ^
+           tables.t[6][(x >> 48) & 0xFF] ^
+           tables.t[7][x >> 56];
+}
+
+uint64_t pLayerTable(uint64_t x)
+{
+    return permuteByTables(PERMUTATION_TABLES, x);
+}
+
+uint64_t invPLayerTable(uint64_t x)
+{
+    return permuteByTables(INVERSE_PERMUTATION_TABLES, x);
+}
+
+uint64_t pLayerShiftFn(uint64_t x)
+{
+    return pLayerShift(x);
+}
+
+uint64_t invPLayerShiftFn(uint64_t x)
+{
+    return invPLayerShift(x);
+}
+
+#ifdef PRESENT_PLAYER_PEXT
+__attribute__((target("bmi2")))
+uint64_t pLayerPext(uint64_t x)
+{
+    return _pext_u64(x, 0x1111111111111111ULL)
+        | (_pext_u64(x, 0x2222222222222222ULL) << 16)
+        | (_pext_u64(x, 0x4444444444444444ULL) << 32)
+        | (_pext_u64(x, 0x8888888888888888ULL) << 48);
+}
+
+// Inverse of pLayerPext: scatter each 16-bit quarter back to every fourth bit
+__attribute__((target("bmi2")))
+uint64_t invPLayerPdep(uint64_t x)
+{
+    return _pdep_u64(x & 0xFFFF, 0x1111111111111111ULL)
+        | _pdep_u64((x >> 16) & 0xFFFF, 0x2222222222222222ULL)
+        | _pdep_u64((x >> 32) & 0xFFFF, 0x4444444444444444ULL)
+        | _pdep_u64(x >> 48, 0x8888888888888888ULL);
+}
+#endif
+
+// Best of a few short dependent chains, so one interruption does not skew the choice.
+double timePermutation(PermutationFn fn)
+{
+    const int iterations = 1 << 14;
+    double best = 0;
+    for (int rep = 0; rep < 5; ++rep) {
+        volatile uint64_t seed = 0x0123456789ABCDEFULL;
+        uint64_t x = seed;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            x = fn(x) + i;
+        }
+        auto end = std::chrono::steady_clock::now();
+        seed = x;
+        double elapsed = std::chrono::duration<double>(end - start).count();
+        if (rep == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+PermutationImpl selectPermutationLayer()
+{
+    PermutationImpl candidates[3] = {
+        {"shift", pLayerShiftFn, invPLayerShiftFn},
+        {"table", pLayerTable, invPLayerTable},
+    };
+    int count = 2;
+#ifdef PRESENT_PLAYER_PEXT
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("bmi2")) {
+        candidates[count++] = {"pext", pLayerPext, invPLayerPdep};
+    }
+#endif
+
+    const char* forced = std::getenv("PRESENT_PLAYER");
+    if (forced != nullptr) {
+        for (int i = 0; i < count; ++i) {
+            if (std::strcmp(forced, candidates[i].name) == 0) {
+                return candidates[i];
+            }
+        }
+    }
+
+    int best = 0;
+    double bestTime = timePermutation(candidates[0].fn);
+    for (int i = 1; i < count; ++i) {
+        double t = timePermutation(candidates[i].fn);
+        if (t < bestTime) {
+            bestTime = t;
+            best = i;
+        }
+    }
+    return candidates[best];
+}
+
+} // namespace
+
+const PermutationImpl& permutationLayer()
+{
+    static const PermutationImpl impl = selectPermutationLayer();
+    return impl;
+}
+
+} // namespace present_detail
@@ -0,0 +1,55 @@
+/*
+ * File: present_player.hh
+ *
+ * Description:    Internal pLayer implementations with runtime selection
+ *
+ * Three interchangeable scalar implementations of the PRESENT bit permutation:
+ * - PEXT: four _pext_u64 gathers (only fast where PEXT is implemented in
+ *   hardware, and unavailable without BMI2)
+ * - shift: four delta swaps, plain shifts and masks
+ * - table: eight 256-entry lookups, one per state byte
+ * The fastest implementation available on the running CPU is chosen once, and
+ * decryption uses the inverse of the same kind (PDEP, reversed delta swaps or
+ * inverse tables).
+ *
+ * Copyright (c) 2025 Ahmet Çobanoğlu
+ * All rights reserved.
+ *
+ * This file is proprietary and confidential. Unauthorized copying, distribution,
+ * modification, or use of this file, via any medium, is strictly prohibited
+ * without express written permission from the copyright holder.
+ */
+
+#ifndef E2A7C5F4_6B0D_4A91_8E3C_5D17F0B94A62
+#define E2A7C5F4_6B0D_4A91_8E3C_5D17F0B94A62
+
+#include <cstdint>
+#include "present_core.hh"
+
+namespace present_detail {
+
+/**
+ * @brief Signature shared by the pLayer implementations
+ */
+typedef uint64_t (*PermutationFn)(uint64_t state);
+
+/**
+ * @brief A pLayer implementation and its name
+ */
+struct PermutationImpl {
+    const char* name; ///< "pext", "shift" or "table"
+    PermutationFn fn; ///< Implementation
+    PermutationFn inverse; ///< Inverse pLayer of the same kind
+};
+
+/**
+ * @brief The pLayer implementation selected for this CPU
+ *
+ * Selected on first use by timing every implementation the CPU supports.
+ * PRESENT_PLAYER=pext|shift|table in the environment forces a choice.
+ */
+const PermutationImpl& permutationLayer();
+
+} // namespace present_detail
+
+#endif /* E2A7C5F4_6B0D_4A91_8E3C_5D17F0B94A62 */
@@ -0,0 +1,208 @@
+#include <cstring>
+#include <stdexcept>
+#include "present_rng.hh"
+
+namespace {
+
+constexpr uint64_t GOLDEN_GAMMA = 0x9E3779B97F4A7C15ULL;
+
+// SplitMix64 finaliser (Stafford variant 13)
+inline uint64_t mix64(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Seed of sub-stream streamId of the generator (seed, stream)
+inline uint64_t splitSeed(uint64_t seed, uint64_t stream, uint64_t streamId)
+{
+    return mix64(mix64(seed ^ mix64(stream + GOLDEN_GAMMA)) + (streamId + 1) * GOLDEN_GAMMA);
+}
+
+// ---- Philox4x32-10 ----
+
+constexpr uint32_t PHILOX_M0 = 0xD2511F53;
+constexpr uint32_t PHILOX_M1 = 0xCD9E8D57;
+constexpr uint32_t PHILOX_W0 = 0x9E3779B9;
+constexpr uint32_t PHILOX_W1 = 0xBB67AE85;
+
+// One 128-bit Philox block, returned as two 64-bit outputs
+inline void philoxBlock(uint64_t seed, uint64_t block, uint64_t stream, uint64_t& out0, uint64_t& out1)
+{
+    uint32_t c0 = static_cast<uint32_t>(block);
+    uint32_t c1 = static_cast<uint32_t>(block >> 32);
+    uint32_t c2 = static_cast<uint32_t>(stream);
+    uint32_t c3 = static_cast<uint32_t>(stream >> 32);
+    uint32_t k0 = static_cast<uint32_t>(seed);
+    uint32_t k1 = static_cast<uint32_t>(seed >> 32);
+
+    for (int round = 0; round < 10; ++round) {
+        const uint64_t p0 = static_cast<uint64_t>(PHILOX_M0) * c0;
+        const uint64_t p1 = static_cast<uint64_t>(PHILOX_M1) * c2;
+        const uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+        const uint32_t n1 = static_cast<uint32_t>(p1);
+        const uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+        const uint32_t n3 = static_cast<uint32_t>(p0);
+        c0 = n0;
+        c1 = n1;
+        c2 = n2;
+        c3 = n3;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    out0 = c0 | (static_cast<uint64_t>(c1) << 32);
+    out1 = c2 | (static_cast<uint64_t>(c3) << 32);
+}
+
+} // namespace
+
+// ---- Rng ----
+
+void Rng::fillPlaintexts(uint64_t* out, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = next();
+    }
+}
+
+void Rng::fillBytes(uint8_t* out, size_t n)
+{
+    for (size_t i = 0; i < n; i += 8) {
+        uint64_t word = next();
+        size_t count = (n - i < 8) ? n - i : 8;
+        for (size_t j = 0; j < count; ++j) {
+            out[i + j] = static_cast<uint8_t>(word >> (8 * j));
+        }
+    }
+}
+
+std::unique_ptr<Rng> Rng::create(const std::string& name, uint64_t seed)
+{
+    if (name == "splitmix") {
+        return std::unique_ptr<Rng>(new SplitMixRng(seed));
+    }
+    if (name == "philox") {
+        return std::unique_ptr<Rng>(new PhiloxRng(seed));
+    }
+    if (name == "present-ctr") {
+        return std::unique_ptr<Rng>(new PresentCtrRng(seed));
+    }
+    throw std::invalid_argument("Unknown random generator: " + name + " (expected splitmix, philox or present-ctr).");
+}
+
+// ---- SplitMixRng ----
+
+SplitMixRng::SplitMixRng(uint64_t seed, uint64_t stream)
+    : base_(seed + mix64(stream)), counter_(0)
+{
+}
+
+uint64_t SplitMixRng::next()
+{
+    return mix64(base_ + ++counter_ * GOLDEN_GAMMA);
+}
+
+void SplitMixRng::fillPlaintexts(uint64_t* out, size_t n)
+{
+    const uint64_t start = base_ + counter_ * GOLDEN_GAMMA;
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = mix64(start + (i + 1) * GOLDEN_GAMMA);
+    }
+    counter_ += n;
+}
+
+void SplitMixRng::discard(uint64_t n)
+{
+    counter_ += n;
+}
+
+std::unique_ptr<Rng> SplitMixRng::split(uint64_t streamId) const
+{
+    return std::unique_ptr<Rng>(new SplitMixRng(splitSeed(base_, 0, streamId)));
+}
+
+// ---- PhiloxRng ----
+
+PhiloxRng::PhiloxRng(uint64_t seed, uint64_t stream)
+    : seed_(seed), stream_(stream), counter_(0)
+{
+}
+
+uint64_t PhiloxRng::next()
+{
+    uint64_t out0 = 0;
+    uint64_t out1 = 0;
+    philoxBlock(seed_, counter_ / 2, stream_, out0, out1);
+    return (counter_++ % 2 == 0) ? out0 : out1;
+}
+
+void PhiloxRng::fillPlaintexts(uint64_t* out, size_t n)
+{
+    size_t i = 0;
+    if (n > 0 && counter_ % 2 == 1) {
+        out[i++] = next();
+    }
+    for (; i + 2 <= n; i += 2) {
+        philoxBlock(seed_, counter_ / 2, stream_, out[i], out[i + 1]);
+        counter_ += 2;
+    }
+    if (i < n) {
+        out[i] = next();
+    }
+}
+
+void PhiloxRng::discard(uint64_t n)
+{
+    counter_ += n;
+}
+
+std::unique_ptr<Rng> PhiloxRng::split(uint64_t streamId) const
+{
+    return std::unique_ptr<Rng>(new PhiloxRng(splitSeed(seed_, stream_, streamId)));
+}
+
+// ---- PresentCtrRng ----
+
+PresentCtrRng::PresentCtrRng(uint64_t seed, uint64_t stream)
+    : seed_(seed), stream_(stream), counter_(0), cipher_(Present::KeySize::KEY_80, 31)
+{
+    if (stream >= (1ULL << 24)) {
+        throw std::invalid_argument("PresentCtrRng stream index must be below 2^24.");
+    }
+
+    uint8_t key[10];
+    const uint64_t extra = mix64(seed);
+    for (int i = 0; i < 8; ++i) {
+        key[i] = static_cast<uint8_t>(seed >> (8 * i));
+    }
+    key[8] = static_cast<uint8_t>(extra);
+    key[9] = static_cast<uint8_t>(extra >> 8);
+    cipher_.setKey(key, sizeof(key));
+}
+
+uint64_t PresentCtrRng::next()
+{
+    return cipher_.encrypt((stream_ << 40) + counter_++);
+}
+
+void PresentCtrRng::fillPlaintexts(uint64_t* out, size_t n)
+{
+    const uint64_t start = (stream_ << 40) + counter_;
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = start + i;
+    }
+    cipher_.encryptBlocks(out, out, n);
+    counter_ += n;
+}
+
+void PresentCtrRng::discard(uint64_t n)
+{
+    counter_ += n;
+}
+
+std::unique_ptr<Rng> PresentCtrRng::split(uint64_t streamId) const
+{
+    return std::unique_ptr<Rng>(new PresentCtrRng(splitSeed(seed_, stream_, streamId)));
+}
@@ -0,0 +1,353 @@
+#include <cstdlib>
+#include <cstring>
+#include "present.hh"
+#include "present_player.hh"
+#include "present_simd.hh"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PRESENT_SIMD_X86 1
+#endif
+
+namespace present_detail {
+
+#ifdef PRESENT_SIMD_X86
+
+namespace {
+
+// Blocks handled per loop iteration: four registers are kept in flight to hide
+// the pshufb latency.
+constexpr int UNROLL = 4;
+
+typedef void (*GroupKernel)(const uint64_t* src, uint64_t* dst,
+                            const uint64_t* roundKeys, int rounds);
+
+// Runs a kernel over whole groups and pads the remainder through a local buffer.
+template <size_t Group>
+void runGroups(const uint64_t* in, uint64_t* out, size_t n,
+               const uint64_t* roundKeys, int rounds, GroupKernel kernel)
+{
+    size_t bulk = n - n % Group;
+    for (size_t i = 0; i < bulk; i += Group) {
+        kernel(in + i, out + i, roundKeys, rounds);
+    }
+    if (bulk < n) {
+        uint64_t buf[Group] = {0};
+        std::memcpy(buf, in + bulk, (n - bulk) * sizeof(uint64_t));
+        kernel(buf, buf, roundKeys, rounds);
+        std::memcpy(out + bulk, buf, (n - bulk) * sizeof(uint64_t));
+    }
+}
+
+// ---- SSSE3: 2 blocks per register ----
+
+__attribute__((target("ssse3")))
+inline __m128i sboxLayer128(__m128i x, __m128i lo, __m128i hi, __m128i nibble)
+{
+    __m128i l = _mm_and_si128(x, nibble);
+    __m128i h = _mm_and_si128(_mm_srli_epi16(x, 4), nibble);
+    return _mm_or_si128(_mm_shuffle_epi8(lo, l), _mm_shuffle_epi8(hi, h));
+}
+
+__attribute__((target("ssse3")))
+inline __m128i deltaSwap128(__m128i x, __m128i m, int s)
+{
+    __m128i t = _mm_and_si128(_mm_xor_si128(_mm_srli_epi64(x, s), x), m);
+    return _mm_xor_si128(x, _mm_xor_si128(t, _mm_slli_epi64(t, s)));
+}
+
+template <bool Decrypt>
+__attribute__((target("ssse3")))
+void groupSsse3(const uint64_t* src, uint64_t* dst,
+                const uint64_t* roundKeys, int rounds)
+{
+    const __m128i lo = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(Decrypt ? Present::INV_SBOX : Present::SBOX));
+    const __m128i hi = _mm_slli_epi16(lo, 4);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i m3 = _mm_set1_epi64x(PLAYER_MASK_3);
+    const __m128i m6 = _mm_set1_epi64x(PLAYER_MASK_6);
+    const __m128i m12 = _mm_set1_epi64x(PLAYER_MASK_12);
+    const __m128i m24 = _mm_set1_epi64x(PLAYER_MASK_24);
+
+    __m128i s[UNROLL];
+    for (int u = 0; u < UNROLL; ++u) {
+        s[u] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src) + u);
+    }
+    if (Decrypt) {
+        const __m128i last = _mm_set1_epi64x(roundKeys[rounds]);
+        for (int u = 0; u < UNROLL; ++u) {
+            s[u] = _mm_xor_si128(s[u], last);
+        }
+        for (int r = rounds - 1; r >= 0; --r) {
+            const __m128i rk = _mm_set1_epi64x(roundKeys[r]);
+            for (int u = 0; u < UNROLL; ++u) {
+                __m128i x = deltaSwap128(s[u], m24, 24);
+                x = deltaSwap128(x, m12, 12);
+                x = deltaSwap128(x, m6, 6);
+                x = deltaSwap128(x, m3, 3);
+                s[u] = _mm_xor_si128(sboxLayer128(x, lo, hi, nibble), rk);
+            }
+        }
+    } else {
+        for (int r = 0; r < rounds; ++r) {
+            const __m128i rk = _mm_set1_epi64x(roundKeys[r]);
+            for (int u = 0; u < UNROLL; ++u) {
+                __m128i x = sboxLayer128(_mm_xor_si128(s[u], rk), lo, hi, nibble);
+                x = deltaSwap128(x, m3, 3);
+                x = deltaSwap128(x, m6, 6);
+                x = deltaSwap128(x, m12, 12);
+                s[u] = deltaSwap128(x, m24, 24);
+            }
+        }
+        const __m128i last = _mm_set1_epi64x(roundKeys[rounds]);
+        for (int u = 0; u < UNROLL; ++u) {
+            s[u] = _mm_xor_si128(s[u], last);
+        }
+    }
+    for (int u = 0; u < UNROLL; ++u) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst) + u, s[u]);
+    }
+}
+
+// ---- AVX2: 4 blocks per register ----
+
+__attribute__((target("avx2")))
+inline __m256i sboxLayer256(__m256i x, __m256i lo, __m256i hi, __m256i nibble)
+{
+    __m256i l = _mm256_and_si256(x, nibble);
+    __m256i h = _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble);
+    return _mm256_or_si256(_mm256_shuffle_epi8(lo, l), _mm256_shuffle_epi8(hi, h));
+}
+
+__attribute__((target("avx2")))
+inline __m256i deltaSwap256(__m256i x, __m256i m, int s)
+{
+    __m256i t = _mm256_and_si256(_mm256_xor_si256(_mm256_srli_epi64(x, s), x), m);
+    return _mm256_xor_si256(x, _mm256_xor_si256(t, _mm256_slli_epi64(t, s)));
+}
+
+template <bool Decrypt>
+__attribute__((target("avx2")))
+void groupAvx2(const uint64_t* src, uint64_t* dst,
+               const uint64_t* roundKeys, int rounds)
+{
+    const __m256i lo = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(Decrypt ? Present::INV_SBOX : Present::SBOX)));
+    const __m256i hi = _mm256_slli_epi16(lo, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i m3 = _mm256_set1_epi64x(PLAYER_MASK_3);
+    const __m256i m6 = _mm256_set1_epi64x(PLAYER_MASK_6);
+    const __m256i m12 = _mm256_set1_epi64x(PLAYER_MASK_12);
+    const __m256i m24 = _mm256_set1_epi64x(PLAYER_MASK_24);
+
+    __m256i s[UNROLL];
+    for (int u = 0; u < UNROLL; ++u) {
+        s[u] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src) + u);
+    }
+    if (Decrypt) {
+        const __m256i last = _mm256_set1_epi64x(roundKeys[rounds]);
+        for (int u = 0; u < UNROLL; ++u) {
+            s[u] = _mm256_xor_si256(s[u], last);
+        }
+        for (int r = rounds - 1; r >= 0; --r) {
+            const __m256i rk = _mm256_set1_epi64x(roundKeys[r]);
+            for (int u = 0; u < UNROLL; ++u) {
+                __m256i x = deltaSwap256(s[u], m24, 24);
+                x = deltaSwap256(x, m12, 12);
+                x = deltaSwap256(x, m6, 6);
+                x = deltaSwap256(x, m3, 3);
+                s[u] = _mm256_xor_si256(sboxLayer256(x, lo, hi, nibble), rk);
+            }
+        }
+    } else {
+        for (int r = 0; r < rounds; ++r) {
+            const __m256i rk = _mm256_set1_epi64x(roundKeys[r]);
+            for (int u = 0; u < UNROLL; ++u) {
+                __m256i x = sboxLayer256(_mm256_xor_si256(s[u], rk), lo, hi, nibble);
+                x = deltaSwap256(x, m3, 3);
+                x = deltaSwap256(x, m6, 6);
+                x = deltaSwap256(x, m12, 12);
+                s[u] = deltaSwap256(x, m24, 24);
+            }
+        }
+        const __m256i last = _mm256_set1_epi64x(roundKeys[rounds]);
+        for (int u = 0; u < UNROLL; ++u) {
+            s[u] = _mm256_xor_si256(s[u], last);
+        }
+    }
+    for (int u = 0; u < UNROLL; ++u) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst) + u, s[u]);
+    }
+}
+
+// ---- AVX-512BW: 8 blocks per register ----
+
+__attribute__((target("avx512f,avx512bw")))
+inline __m512i sboxLayer512(__m512i x, __m512i lo, __m512i hi, __m512i nibble)
+{
+    __m512i l = _mm512_and_si512(x, nibble);
+    __m512i h = _mm512_and_si512(_mm512_srli_epi16(x, 4), nibble);
+    return _mm512_or_si512(_mm512_shuffle_epi8(lo, l), _mm512_shuffle_epi8(hi, h));
+}
+
+__attribute__((target("avx512f,avx512bw")))
+inline __m512i deltaSwap512(__m512i x, __m512i m, int s)
+{
+    // 0x28 = (a ^ b) & c, 0x96 = a ^ b ^ c
+    __m512i t = _mm512_ternarylogic_epi64(_mm512_srli_epi64(x, s), x, m, 0x28);
+    return _mm512_ternarylogic_epi64(x, t, _mm512_slli_epi64(t, s), 0x96);
+}
+
+template <bool Decrypt>
+__attribute__((target("avx512f,avx512bw")))
+void groupAvx512(const uint64_t* src, uint64_t* dst,
+                 const uint64_t* roundKeys, int rounds)
+{
+    const __m512i lo = _mm512_broadcast_i32x4(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(Decrypt ? Present::INV_SBOX : Present::SBOX)));
+    const __m512i hi = _mm512_slli_epi16(lo, 4);
+    const __m512i nibble = _mm512_set1_epi8(0x0F);
+    const __m512i m3 = _mm512_set1_epi64(PLAYER_MASK_3);
+    const __m512i m6 = _mm512_set1_epi64(PLAYER_MASK_6);
+    const __m512i m12 = _mm512_set1_epi64(PLAYER_MASK_12);
+    const __m512i m24 = _mm512_set1_epi64(PLAYER_MASK_24);
+
+    __m512i s[UNROLL];
+    for (int u = 0; u < UNROLL; ++u) {
+        s[u] = _mm512_loadu_si512(src + 8 * u);
+    }
+    if (Decrypt) {
+        const __m512i last = _mm512_set1_epi64(roundKeys[rounds]);
+        for (int u = 0; u < UNROLL; ++u) {
+            s[u] = _mm512_xor_si512(s[u], last);
+        }
+        for (int r = rounds - 1; r >= 0; --r) {
+            const __m512i rk = _mm512_set1_epi64(roundKeys[r]);
+            for (int u = 0; u < UNROLL; ++u) {
+                __m512i x = deltaSwap512(s[u], m24, 24);
+                x = deltaSwap512(x, m12, 12);
+                x = deltaSwap512(x, m6, 6);
+                x = deltaSwap512(x, m3, 3);
+                s[u] = _mm512_xor_si512(sboxLayer512(x, lo, hi, nibble), rk);
+            }
+        }
+    } else {
+        for (int r = 0; r < rounds; ++r) {
+            const __m512i rk = _mm512_set1_epi64(roundKeys[r]);
+            for (int u = 0; u < UNROLL; ++u) {
+                __m512i x = sboxLayer512(_mm512_xor_si512(s[u], rk), lo, hi, nibble);
+                x = deltaSwap512(x, m3, 3);
+                x = deltaSwap512(x, m6, 6);
+                x = deltaSwap512(x, m12, 12);
+                s[u] = deltaSwap512(x, m24, 24);
+            }
+        }
+        const __m512i last = _mm512_set1_epi64(roundKeys[rounds]);
+        for (int u = 0; u < UNROLL; ++u) {
+            s[u] = _mm512_xor_si512(s[u], last);
+        }
+    }
+    for (int u = 0; u < UNROLL; ++u) {
+        _mm512_storeu_si512(dst + 8 * u, s[u]);
+    }
+}
+
+SimdLevel detectSimdLevel()
+{
+    __builtin_cpu_init();
+    SimdLevel level = SimdLevel::None;
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        level = SimdLevel::Avx512;
+    } else if (__builtin_cpu_supports("avx2")) {
+        level = SimdLevel::Avx2;
+    } else if (__builtin_cpu_supports("ssse3")) {
+        level = SimdLevel::Ssse3;
+    }
+
+    // PRESENT_SIMD_MAX caps the level, so the narrower kernels can be tested
+    // and compared on a machine that supports the wider ones.
+    const char* cap = std::getenv("PRESENT_SIMD_MAX");
+    if (cap != nullptr) {
+        const SimdLevel levels[] = {SimdLevel::None, SimdLevel::Ssse3, SimdLevel::Avx2, SimdLevel::Avx512};
+        for (SimdLevel l : levels) {
+            if (std::strcmp(cap, simdLevelName(l)) == 0 && l < level) {
+                level = l;
+            }
+        }
+    }
+    return level;
+}
+
+} // namespace
+
+SimdLevel simdLevel()
+{
+    static const SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+template <bool Decrypt>
+void simdProcessBlocks(const uint64_t* in, uint64_t* out, size_t n,
+                       const uint64_t* roundKeys, int rounds)
+{
+    switch (simdLevel()) {
+    case SimdLevel::Avx512:
+        runGroups<8 * UNROLL>(in, out, n, roundKeys, rounds, groupAvx512<Decrypt>);
+        break;
+    case SimdLevel::Avx2:
+        runGroups<4 * UNROLL>(in, out, n, roundKeys, rounds, groupAvx2<Decrypt>);
+        break;
+    case SimdLevel::Ssse3:
+        runGroups<2 * UNROLL>(in, out, n, roundKeys, rounds, groupSsse3<Decrypt>);
+        break;
+    case SimdLevel::None:
+        break;
+    }
+}
+
+void simdEncryptBlocks(const uint64_t* in, uint64_t* out, size_t n,
+                       const uint64_t* roundKeys, int rounds)
+{
+    simdProcessBlocks<false>(in, out, n, roundKeys, rounds);
+}
+
+void simdDecryptBlocks(const uint64_t* in, uint64_t* out, size_t n,
+                       const uint64_t* roundKeys, int rounds)
+{
+    simdProcessBlocks<true>(in, out, n, roundKeys, rounds);
+}
+
+#else // !PRESENT_SIMD_X86
+
+SimdLevel simdLevel()
+{
+    return SimdLevel::None;
+}
+
+void simdEncryptBlocks(const uint64_t*, uint64_t*, size_t, const uint64_t*, int)
+{
+}
+
+void simdDecryptBlocks(const uint64_t*, uint64_t*, size_t, const uint64_t*, int)
+{
+}
+
+#endif // PRESENT_SIMD_X86
+
+const char* simdLevelName(SimdLevel level)
+{
+    switch (level) {
+    case SimdLevel::Ssse3:
+        return "ssse3";
+    case SimdLevel::Avx2:
+        return "avx2";
+    case SimdLevel::Avx512:
+        return "avx512bw";
+    case SimdLevel::None:
+        break;
+    }
+    return "none";
+}
+
+} // namespace present_detail
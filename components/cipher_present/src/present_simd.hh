@@ -0,0 +1,78 @@
+/*
+ * File: present_simd.hh
+ *
+ * Description:    Internal SIMD PRESENT kernels with runtime dispatch
+ *
+ * Each vector register holds several 64-bit blocks (2 with SSSE3, 4 with AVX2,
+ * 8 with AVX-512). The S-box is two 16-entry nibble lookups per byte through
+ * pshufb, and pLayer is the same four delta swaps on every lane. The widest
+ * instruction set supported by the running CPU is selected once.
+ *
+ * Copyright (c) 2025 Ahmet Çobanoğlu
+ * All rights reserved.
+ *
+ * This file is proprietary and confidential. Unauthorized copying, distribution,
+ * modification, or use of this file, via any medium, is strictly prohibited
+ * without express written permission from the copyright holder.
+ */
+
+#ifndef FF1C917D_BF73_40F2_9561_EFCC62AB19AE
+#define FF1C917D_BF73_40F2_9561_EFCC62AB19AE
+
+#include <cstdint>
+#include <cstddef>
+
+namespace present_detail {
+
+/**
+ * @brief Instruction set levels available to the SIMD engine
+ */
+enum class SimdLevel {
+    None,    ///< No usable SIMD, the engine falls back to scalar code
+    Ssse3,   ///< 128-bit pshufb, 2 blocks per register
+    Avx2,    ///< 256-bit vpshufb, 4 blocks per register
+    Avx512   ///< 512-bit vpshufb (AVX-512BW), 8 blocks per register
+};
+
+/**
+ * @brief Widest SIMD level supported by the running CPU (detected once)
+ */
+SimdLevel simdLevel();
+
+/**
+ * @brief Human readable name of a SIMD level
+ */
+const char* simdLevelName(SimdLevel level);
+
+/**
+ * @brief Encrypt n blocks with the SIMD kernel of the detected level
+ *
+ * Must only be called when simdLevel() is not SimdLevel::None.
+ *
+ * @param in Input blocks
+ * @param out Output blocks (may alias in)
+ * @param n Number of blocks
+ * @param roundKeys rounds + 1 round keys
+ * @param rounds Number of rounds
+ */
+void simdEncryptBlocks(const uint64_t* in, uint64_t* out, size_t n,
+                       const uint64_t* roundKeys, int rounds);
+
+/**
+ * @brief Decrypt n blocks with the SIMD kernel of the detected level
+ *
+ * Same kernels run backwards: reversed delta swaps, then the inverse S-box
+ * shuffle. Must only be called when simdLevel() is not SimdLevel::None.
+ *
+ * @param in Input blocks
+ * @param out Output blocks (may alias in)
+ * @param n Number of blocks
+ * @param roundKeys rounds + 1 round keys
+ * @param rounds Number of rounds
+ */
+void simdDecryptBlocks(const uint64_t* in, uint64_t* out, size_t n,
+                       const uint64_t* roundKeys, int rounds);
+
+} // namespace present_detail
+
+#endif /* FF1C917D_BF73_40F2_9561_EFCC62AB19AE */
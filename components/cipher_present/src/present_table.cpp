@@ -0,0 +1,91 @@
+#include <vector>
+#include "present.hh"
+#include "present_table.hh"
+
+namespace present_detail {
+
+namespace {
+
+// Independent blocks interleaved per iteration so the lookups of one block
+// overlap with the XOR chain of the others.
+constexpr size_t INTERLEAVE = 4;
+
+} // namespace
+
+void tableEncryptBlocks(const uint64_t* in, uint64_t* out, size_t n,
+                        const uint64_t* roundKeys, int rounds)
+{
+    size_t i = 0;
+    for (; i + INTERLEAVE <= n; i += INTERLEAVE) {
+        uint64_t s0 = in[i];
+        uint64_t s1 = in[i + 1];
+        uint64_t s2 = in[i + 2];
+        uint64_t s3 = in[i + 3];
+        for (int r = 0; r < rounds; ++r) {
+            const uint64_t rk = roundKeys[r];
+            s0 = tableRound(s0 ^ rk);
+            s1 = tableRound(s1 ^ rk);
+            s2 = tableRound(s2 ^ rk);
+            s3 = tableRound(s3 ^ rk);
+        }
+        const uint64_t rk = roundKeys[rounds];
+        out[i] = s0 ^ rk;
+        out[i + 1] = s1 ^ rk;
+        out[i + 2] = s2 ^ rk;
+        out[i + 3] = s3 ^ rk;
+    }
+    for (; i < n; ++i) {
+        uint64_t s = in[i];
+        for (int r = 0; r < rounds; ++r) {
+            s = tableRound(s ^ roundKeys[r]);
+        }
+        out[i] = s ^ roundKeys[rounds];
+    }
+}
+
+void tableDecryptBlocks(const uint64_t* in, uint64_t* out, size_t n,
+                        const uint64_t* roundKeys, int rounds)
+{
+    if (rounds == 0) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = in[i] ^ roundKeys[0];
+        }
+        return;
+    }
+
+    // y = invP(state) throughout; the inner round keys move into that domain
+    std::vector<uint64_t> invKeys(rounds);
+    for (int r = 1; r < rounds; ++r) {
+        invKeys[r] = invPLayerShift(roundKeys[r]);
+    }
+    const uint64_t first = roundKeys[rounds];
+    const uint64_t last = roundKeys[0];
+
+    size_t i = 0;
+    for (; i + INTERLEAVE <= n; i += INTERLEAVE) {
+        uint64_t y0 = invPLayerShift(in[i] ^ first);
+        uint64_t y1 = invPLayerShift(in[i + 1] ^ first);
+        uint64_t y2 = invPLayerShift(in[i + 2] ^ first);
+        uint64_t y3 = invPLayerShift(in[i + 3] ^ first);
+        for (int r = rounds - 1; r >= 1; --r) {
+            const uint64_t rk = invKeys[r];
+            y0 = invTableRound(y0) ^ rk;
+            y1 = invTableRound(y1) ^ rk;
+            y2 = invTableRound(y2) ^ rk;
+            y3 = invTableRound(y3) ^ rk;
+        }
+        out[i] = invSBoxLayer(y0) ^ last;
+        out[i + 1] = invSBoxLayer(y1) ^ last;
+        out[i + 2] = invSBoxLayer(y2) ^ last;
+        out[i + 3] = invSBoxLayer(y3) ^ last;
+    }
+    for (; i < n; ++i) {
+        uint64_t y = invPLayerShift(in[i] ^ first);
+        for (int r = rounds - 1; r >= 1; --r) {
+            y = invTableRound(y) ^ invKeys[r];
+        }
+        out[i] = invSBoxLayer(y) ^ last;
+    }
+}
+
+} // namespace present_detail
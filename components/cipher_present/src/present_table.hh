@@ -0,0 +1,58 @@
+/*
+ * File: present_table.hh
+ *
+ * Description:    Internal table-driven (T-table) PRESENT kernel
+ *
+ * The S-box layer and pLayer of one round are merged into eight 256-entry
+ * tables (spTables() in present_core.hh), one per input byte, so a round is
+ * eight lookups and XORs. This kernel interleaves independent blocks to hide
+ * the lookup latency.
+ *
+ * Copyright (c) 2025 Ahmet Çobanoğlu
+ * All rights reserved.
+ *
+ * This file is proprietary and confidential. Unauthorized copying, distribution,
+ * modification, or use of this file, via any medium, is strictly prohibited
+ * without express written permission from the copyright holder.
+ */
+
+#ifndef B50BEC21_7588_4DE6_B179_71E2E5C9FE6B
+#define B50BEC21_7588_4DE6_B179_71E2E5C9FE6B
+
+#include <cstdint>
+#include <cstddef>
+#include "present_core.hh"
+
+namespace present_detail {
+
+/**
+ * @brief Encrypt n blocks with the table kernel
+ *
+ * @param in Input blocks
+ * @param out Output blocks (may alias in)
+ * @param n Number of blocks
+ * @param roundKeys rounds + 1 round keys
+ * @param rounds Number of rounds
+ */
+void tableEncryptBlocks(const uint64_t* in, uint64_t* out, size_t n,
+                        const uint64_t* roundKeys, int rounds);
+
+/**
+ * @brief Decrypt n blocks with the inverse tables
+ *
+ * Works on y = invP(state) so that each round is one pass through the inverse
+ * tables (see invTableRound()), with the round keys transformed by invP once
+ * per call.
+ *
+ * @param in Input blocks
+ * @param out Output blocks (may alias in)
+ * @param n Number of blocks
+ * @param roundKeys rounds + 1 round keys
+ * @param rounds Number of rounds
+ */
+void tableDecryptBlocks(const uint64_t* in, uint64_t* out, size_t n,
+                        const uint64_t* roundKeys, int rounds);
+
+} // namespace present_detail
+
+#endif /* B50BEC21_7588_4DE6_B179_71E2E5C9FE6B */
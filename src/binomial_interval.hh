@@ -0,0 +1,69 @@
+/*
+ * File: binomial_interval.hh
+ *
+ * Description:    Confidence intervals for probabilities estimated by counting
+ *
+ * The experiments count hits among n independent trials. The Wilson score
+ * interval is used instead of the normal approximation because the counts of
+ * interest are small (tens of right pairs among billions of trials) and can
+ * be zero, where the normal interval collapses to a point. Its upper bound
+ * for zero hits, about z^2 / n, is what lets a sampling run reject a
+ * characteristic early.
+ *
+ * Copyright (c) 2025 Ahmet Çobanoğlu
+ * All rights reserved.
+ *
+ * This file is proprietary and confidential. Unauthorized copying, distribution,
+ * modification, or use of this file, via any medium, is strictly prohibited
+ * without express written permission from the copyright holder.
+ */
+
+#ifndef FD67BB31_ADBB_4051_A27A_97CBE8DD4FEF
+#define FD67BB31_ADBB_4051_A27A_97CBE8DD4FEF
+
+#include <cmath>
+#include <cstdint>
+
+const double Z_95 = 1.959963984540054; ///< Two-sided 95% normal quantile
+
+/**
+ * @brief A probability estimate with its confidence interval
+ */
+struct BinomialInterval {
+    double estimate; ///< hits / trials
+    double low;      ///< Lower bound
+    double high;     ///< Upper bound
+
+    /**
+     * @brief Half the width of the interval relative to the estimate, infinite without hits
+     */
+    double relativeError() const
+    {
+        return estimate > 0.0 ? (high - low) / (2.0 * estimate) : INFINITY;
+    }
+};
+
+/**
+ * @brief Wilson score interval for hits successes among trials
+ *
+ * @param hits Number of successes
+ * @param trials Number of trials (an empty interval [0, 1] if zero)
+ * @param z Normal quantile of the confidence level, Z_95 by default
+ */
+inline BinomialInterval wilsonInterval(uint64_t hits, uint64_t trials, double z = Z_95)
+{
+    if (trials == 0) {
+        return {0.0, 0.0, 1.0};
+    }
+    const double n = static_cast<double>(trials);
+    const double p = static_cast<double>(hits) / n;
+    const double z2 = z * z;
+    const double center = (p + z2 / (2.0 * n)) / (1.0 + z2 / n);
+    const double half = z * std::sqrt(p * (1.0 - p) / n + z2 / (4.0 * n * n)) / (1.0 + z2 / n);
+    // The bounds are exact at the ends, not left to rounding
+    const double low = hits == 0 ? 0.0 : std::fmax(0.0, center - half);
+    const double high = hits == trials ? 1.0 : std::fmin(1.0, center + half);
+    return {p, low, high};
+}
+
+#endif /* FD67BB31_ADBB_4051_A27A_97CBE8DD4FEF */
@@ -0,0 +1,101 @@
+/*
+ * File: difference_histogram.hh
+ *
+ * Description:    Output-difference histogram for the differential experiments
+ *
+ * DifferenceHistogram counts 64-bit differences in a DifferenceTable, with
+ * the zero difference counted on the side. Only differences
+ * with at most maxActive non-zero nibbles are recorded, which keeps the table
+ * small enough to stay mostly in cache and makes the counts exact. Every
+ * thread fills its own histogram; they are merged once at the end.
+ *
+ * Copyright (c) 2025 Ahmet Çobanoğlu
+ * All rights reserved.
+ *
+ * This file is proprietary and confidential. Unauthorized copying, distribution,
+ * modification, or use of this file, via any medium, is strictly prohibited
+ * without express written permission from the copyright holder.
+ */
+
+#ifndef EAAC6285_1FBD_45E3_B5EA_7268F8C2E59F
+#define EAAC6285_1FBD_45E3_B5EA_7268F8C2E59F
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "difference_map.hh"
+#include "nibble_activity.hh"
+
+/**
+ * @brief Exact counts of the output differences with few active nibbles
+ */
+class DifferenceHistogram {
+public:
+    /**
+     * @param maxActive Largest number of active nibbles that is recorded
+     */
+    explicit DifferenceHistogram(int maxActive) : maxActive_(maxActive), zeroCount_(0) {}
+
+    /**
+     * @brief Record one difference (ignored if it has too many active nibbles)
+     */
+    void add(uint64_t diff, uint64_t count = 1)
+    {
+        if (activeNibbles(diff) > maxActive_) {
+            return;
+        }
+        if (diff == 0) { // 0 marks an empty slot
+            zeroCount_ += count;
+            return;
+        }
+        table_.add(diff, count);
+    }
+
+    /**
+     * @brief Add every count of another histogram to this one
+     */
+    void merge(const DifferenceHistogram& other)
+    {
+        zeroCount_ += other.zeroCount_;
+        table_.merge(other.table_);
+    }
+
+    /**
+     * @brief The k most frequent differences, most frequent first
+     *
+     * Ties are broken by the smaller difference so the report is deterministic.
+     */
+    std::vector<std::pair<uint64_t, uint64_t>> top(size_t k) const
+    {
+        std::vector<std::pair<uint64_t, uint64_t>> entries;
+        entries.reserve(table_.size() + 1);
+        if (zeroCount_ > 0) {
+            entries.emplace_back(0, zeroCount_);
+        }
+        table_.forEach(0, table_.slotCount(),
+                       [&entries](uint64_t diff, uint64_t count) { entries.emplace_back(diff, count); });
+
+        k = std::min(k, entries.size());
+        std::partial_sort(entries.begin(), entries.begin() + k, entries.end(),
+                          [](const std::pair<uint64_t, uint64_t>& a, const std::pair<uint64_t, uint64_t>& b) {
+                              return a.second != b.second ? a.second > b.second : a.first < b.first;
+                          });
+        entries.resize(k);
+        return entries;
+    }
+
+    /**
+     * @brief Number of distinct differences recorded
+     */
+    size_t size() const { return table_.size() + (zeroCount_ > 0 ? 1 : 0); }
+
+private:
+    int maxActive_;                   ///< Largest number of active nibbles recorded
+    uint64_t zeroCount_;              ///< Count of the zero difference (kept out of the table)
+    DifferenceTable<uint64_t> table_; ///< Counts of the non-zero differences
+};
+
+#endif /* EAAC6285_1FBD_45E3_B5EA_7268F8C2E59F */
@@ -0,0 +1,149 @@
+/*
+ * File: difference_map.hh
+ *
+ * Description:    Sparse vectors over 64-bit differences
+ *
+ * DifferenceTable maps non-zero differences to values that are added up, in
+ * an open-addressing hash table (linear probing, 16-byte slots for 8-byte
+ * values, grown at half load). DifferenceMap holds probabilities: the
+ * propagation tools keep one per round and per worker thread, and walk the
+ * slots in ranges so a round is split between threads. DifferenceHistogram
+ * keeps its counts in a DifferenceTable<uint64_t>.
+ *
+ * Copyright (c) 2025 Ahmet Çobanoğlu
+ * All rights reserved.
+ *
+ * This file is proprietary and confidential. Unauthorized copying, distribution,
+ * modification, or use of this file, via any medium, is strictly prohibited
+ * without express written permission from the copyright holder.
+ */
+
+#ifndef FC557B41_59F2_47FA_AF87_3B82099AB18D
+#define FC557B41_59F2_47FA_AF87_3B82099AB18D
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Values added up per non-zero 64-bit difference
+ *
+ * @tparam Value Arithmetic type of the values (counts or probabilities)
+ */
+template <typename Value>
+class DifferenceTable {
+public:
+    DifferenceTable() : size_(0), slots_(1024) {}
+
+    /**
+     * @brief Add value to difference diff (diff must be non-zero)
+     */
+    void add(uint64_t diff, Value value)
+    {
+        Slot& slot = find(diff);
+        if (slot.diff == 0) {
+            slot.diff = diff;
+            if (++size_ * 2 > slots_.size()) {
+                slot.value = value;
+                grow();
+                return;
+            }
+        }
+        slot.value += value;
+    }
+
+    /**
+     * @brief Add every entry of another table to this one
+     */
+    void merge(const DifferenceTable& other)
+    {
+        for (const Slot& slot : other.slots_) {
+            if (slot.diff != 0) {
+                add(slot.diff, slot.value);
+            }
+        }
+    }
+
+    /**
+     * @brief Value of diff, 0 if absent
+     */
+    Value get(uint64_t diff) const
+    {
+        const size_t mask = slots_.size() - 1;
+        size_t i = hash(diff) & mask;
+        while (slots_[i].diff != 0) {
+            if (slots_[i].diff == diff) {
+                return slots_[i].value;
+            }
+            i = (i + 1) & mask;
+        }
+        return Value();
+    }
+
+    /**
+     * @brief Call fn(diff, value) for the entries in slots [begin, end)
+     */
+    template <typename Fn>
+    void forEach(size_t begin, size_t end, Fn fn) const
+    {
+        for (size_t i = begin; i < end; ++i) {
+            if (slots_[i].diff != 0) {
+                fn(slots_[i].diff, slots_[i].value);
+            }
+        }
+    }
+
+    /**
+     * @brief Remove every entry (keeps the table size)
+     */
+    void clear()
+    {
+        slots_.assign(slots_.size(), Slot());
+        size_ = 0;
+    }
+
+    size_t size() const { return size_; }            ///< Number of entries
+    size_t slotCount() const { return slots_.size(); } ///< Number of slots, the range of forEach()
+
+private:
+    struct Slot {
+        uint64_t diff = 0;
+        Value value = Value();
+    };
+
+    static size_t hash(uint64_t diff)
+    {
+        return static_cast<size_t>((diff * 0x9E3779B97F4A7C15ULL) >> 32);
+    }
+
+    Slot& find(uint64_t diff)
+    {
+        const size_t mask = slots_.size() - 1;
+        size_t i = hash(diff) & mask;
+        while (slots_[i].diff != 0 && slots_[i].diff != diff) {
+            i = (i + 1) & mask;
+        }
+        return slots_[i];
+    }
+
+    void grow()
+    {
+        std::vector<Slot> old(slots_.size() * 2);
+        old.swap(slots_);
+        for (const Slot& slot : old) {
+            if (slot.diff != 0) {
+                find(slot.diff) = slot;
+            }
+        }
+    }
+
+    size_t size_;             ///< Number of occupied slots
+    std::vector<Slot> slots_; ///< Open-addressing table, size is a power of two
+};
+
+/**
+ * @brief Probabilities of non-zero 64-bit differences
+ */
+using DifferenceMap = DifferenceTable<double>;
+
+#endif /* FC557B41_59F2_47FA_AF87_3B82099AB18D */
@@ -1,95 +1,574 @@
 #include <iostream>
 #include <vector>
 #include <cstdint>
-#include <random>
 #include <cmath>    // For log2
 #include <iomanip>  // For std::fixed, std::setprecision, std::setw, std::setfill
 #include <numeric>  // For std::accumulate
 #include <string>   // For std::stoll
 #include <stdexcept> // For std::runtime_error, std::invalid_argument
+#include <algorithm> // For std::min
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <sstream>
+#include <chrono>
+#include <fstream>
 
 #include "present.hh" // Assuming this is in the include path via CMake
+#include "present_rng.hh"
+#include "thread_pool.hh"
+#include "difference_histogram.hh"
+#include "binomial_interval.hh"
+#include "result_file.hh"
+#include "telemetry.hh"
+#include "probability_format.hh"
 
 // Constants
-const int NUM_KEYS = 100;
-const int NUM_ROUNDS_CIPHER = 4; // For the PRESENT cipher configuration
-const uint64_t ALPHA = 0x0000000000004004ULL; // Input difference: x0=4, x3=4
-const uint64_t BETA = ALPHA; // Output difference, same as ALPHA for iterative characteristic
+const uint64_t DEFAULT_ALPHA = 0x0000000000004004ULL; // Input difference: x0=4, x3=4
+const uint64_t DEFAULT_BETA = DEFAULT_ALPHA; // Output difference, same as alpha for iterative characteristic
+const uint64_t DEFAULT_SEED = 0x50524553454E5421ULL; // Fixes every key and plaintext of a run
+const long long CHUNK_PLAINTEXTS = 1LL << 20; // Plaintexts per parallel task
 
-// N_PLAINTEXTS will be configurable, default to 2^25
+// Configurable with --keys, --plaintexts and --rounds; in adaptive mode N_PLAINTEXTS is the most a key may use
+int NUM_KEYS = 100;
 long long N_PLAINTEXTS = 1LL << 25;
+int NUM_ROUNDS_CIPHER = 4; // For the PRESENT cipher configuration
+
+const double DEFAULT_CHECKPOINT_SECONDS = 60.0; // Time between result file updates
+const double DEFAULT_TELEMETRY_SECONDS = 10.0;  // Time between telemetry reports
+
+// Adaptive mode: plaintexts per key of the first batch; every batch doubles the total
+const long long ADAPTIVE_FIRST_BATCH = 1LL << 16;
+
+const size_t HISTOGRAM_BATCH = 1024; // Pairs encrypted at a time in histogram mode
+
+// Key k of the run: sub-stream 0 of the key's stream
+std::vector<uint8_t> deriveKey(const Rng& keyStream, size_t keyLengthBytes) {
+    std::vector<uint8_t> key(keyLengthBytes);
+    keyStream.split(0)->fillBytes(key.data(), key.size());
+    return key;
+}
+
+// Per-thread state: a private cipher instance, private counters and histogram
+struct WorkerState {
+    explicit WorkerState(int maxActive)
+        : cipher(Present::KeySize::KEY_80, NUM_ROUNDS_CIPHER), currentKey(-1), counters(NUM_KEYS, 0),
+          roundCounters(NUM_ROUNDS_CIPHER, 0), roundHits(NUM_ROUNDS_CIPHER), histogram(maxActive),
+          pairs(2 * HISTOGRAM_BATCH) {}
+
+    Present cipher;
+    int currentKey;                 // Key index currently loaded into cipher
+    std::vector<long long> counters; // Right pairs found by this thread, per key
+    std::vector<uint64_t> roundCounters; // Trail mode: pairs matching each round's difference, all keys
+    std::vector<uint64_t> roundHits;     // Trail mode: the same for one chunk
+    DifferenceHistogram histogram;  // Output differences seen by this thread (histogram mode)
+    std::vector<uint64_t> pairs;    // Pair buffer for histogram mode
+};
+
+// Nanoseconds on the steady clock, for the telemetry phase times
+uint64_t nowNanos() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Histogram mode: record the output difference of every pair and return the
+// number of pairs that hit beta. With a profile, the time of each phase is
+// added to it like Present::countDifferential() does.
+long long countWithHistogram(WorkerState& state, Rng& gen, long long n, uint64_t alpha, uint64_t beta,
+                             Present::CountProfile* profile) {
+    uint64_t* first = state.pairs.data();
+    uint64_t* second = state.pairs.data() + HISTOGRAM_BATCH;
+    long long hits = 0;
+    uint64_t t0 = profile ? nowNanos() : 0;
+
+    for (long long done = 0; done < n; done += HISTOGRAM_BATCH) {
+        const size_t count = static_cast<size_t>(std::min<long long>(HISTOGRAM_BATCH, n - done));
+        gen.fillPlaintexts(first, count);
+        for (size_t i = 0; i < count; ++i) {
+            second[i] = first[i] ^ alpha;
+        }
+        uint64_t t1 = profile ? nowNanos() : 0;
+        state.cipher.encryptBlocks(first, first, count);
+        state.cipher.encryptBlocks(second, second, count);
+        uint64_t t2 = profile ? nowNanos() : 0;
+
+        for (size_t i = 0; i < count; ++i) {
+            const uint64_t output_diff = first[i] ^ second[i];
+            hits += (output_diff == beta);
+            state.histogram.add(output_diff);
+        }
+        if (profile) {
+            const uint64_t t3 = nowNanos();
+            profile->rngNanos += t1 - t0;
+            profile->encryptNanos += t2 - t1;
+            profile->compareNanos += t3 - t2;
+            t0 = t3;
+        }
+    }
+    return hits;
+}
+
+// One parallel task: plaintexts [begin, end) of a key
+struct Task {
+    int key;
+    long long begin;
+    long long end;
+};
+
+// Chunks of the plaintexts [from[k], to) of keys [firstKey, lastKey), key by
+// key, so every prefix of the list leaves a prefix of each key's plaintexts done
+std::vector<Task> makeTasks(int firstKey, int lastKey, const std::vector<long long>& from, long long to) {
+    std::vector<Task> tasks;
+    for (int k = firstKey; k < lastKey; ++k) {
+        for (long long begin = from[k]; begin < to; begin += CHUNK_PLAINTEXTS) {
+            tasks.push_back({k, begin, std::min(begin + CHUNK_PLAINTEXTS, to)});
+        }
+    }
+    return tasks;
+}
+
+// Trail mode: parse comma separated differences
+bool parseTrail(const std::string& value, std::vector<uint64_t>& trail) {
+    std::istringstream in(value);
+    std::string item;
+    trail.clear();
+    while (std::getline(in, item, ',')) {
+        try {
+            trail.push_back(std::stoull(item, nullptr, 0));
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return !trail.empty();
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--seed <value>] [--rng splitmix|philox|present-ctr]"
+              << " [--alpha <diff>] [--beta <diff>] [--histogram [--max-active <k>] [--top <K>]]"
+              << " [--trail <d1,d2,d3>] [--keys <k>] [--plaintexts <n>]"
+              << " [--adaptive [--rel-error <e>] [--reject-below <w>]] [--rounds <r>]"
+              << " [--shard <i>/<n>] [--output <file> [--checkpoint <seconds>]]"
+              << " [--telemetry <seconds>] [--telemetry-file <file.json>]" << std::endl;
+    std::cerr << "  --alpha/--beta default to the 0x4004 characteristic; trail_search --emit-args prints the best pair." << std::endl;
+    std::cerr << "  --trail gives the differences after rounds 1 .. r - 1 and reports the right pairs of every" << std::endl;
+    std::cerr << "  prefix in the same pass." << std::endl;
+    std::cerr << "  --adaptive runs in doubling batches of up to --plaintexts per key and stops once the 95%" << std::endl;
+    std::cerr << "  interval of P is within e of it (default 0.05), or entirely below 2^-w (default 32)." << std::endl;
+    std::cerr << "  --shard i/n counts only the i-th of n key ranges. --output keeps the counters in a result" << std::endl;
+    std::cerr << "  file, rewritten every --checkpoint seconds (default 60), which a rerun resumes from;" << std::endl;
+    std::cerr << "  merge_results combines the files of all shards." << std::endl;
+    std::cerr << "  --telemetry prints throughput, ETA, time per phase and key progress to stderr every" << std::endl;
+    std::cerr << "  <seconds>; --telemetry-file rewrites the same snapshot as JSON (every 10 s by default)." << std::endl;
+}
 
 int main(int argc, char* argv[]) {
 
-    std::cout << "Starting differential cryptanalysis experiment on 4-round PRESENT..." << std::endl;
+    uint64_t seed = DEFAULT_SEED;
+    uint64_t alpha = DEFAULT_ALPHA;
+    uint64_t beta = DEFAULT_BETA;
+    std::string rng_name = "splitmix";
+    bool histogram_mode = false;
+    int max_active = 2;   // Histogram mode: largest number of active output nibbles recorded
+    size_t top_k = 20;    // Histogram mode: number of differences reported
+    std::vector<uint64_t> trail; // Trail mode: differences after rounds 1 .. NUM_ROUNDS_CIPHER - 1
+    bool adaptive = false;
+    double rel_error = 0.05;      // Adaptive mode: target relative half-width of the interval
+    int reject_weight = 32;       // Adaptive mode: reject once the interval lies below 2^-reject_weight
+    unsigned shard_index = 0;
+    unsigned shard_count = 1;
+    std::string output_path;      // Result file, empty for none
+    double checkpoint_seconds = DEFAULT_CHECKPOINT_SECONDS;
+    double telemetry_seconds = 0.0; // Telemetry report interval, 0 for no report lines
+    std::string telemetry_path;     // Telemetry JSON export, empty for none
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--histogram") {
+            histogram_mode = true;
+        } else if (arg == "--adaptive") {
+            adaptive = true;
+        } else if ((arg == "--rel-error" || arg == "--checkpoint" || arg == "--telemetry") && i + 1 < argc) {
+            std::string value = argv[++i];
+            double number = 0.0;
+            try {
+                number = std::stod(value);
+            } catch (const std::exception&) {
+                number = 0.0;
+            }
+            if (!(number > 0.0)) {
+                std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+                return 1;
+            }
+            (arg == "--rel-error" ? rel_error : arg == "--checkpoint" ? checkpoint_seconds : telemetry_seconds) = number;
+        } else if (arg == "--output" && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (arg == "--telemetry-file" && i + 1 < argc) {
+            telemetry_path = argv[++i];
+        } else if (arg == "--shard" && i + 1 < argc) {
+            std::string value = argv[++i];
+            const size_t slash = value.find('/');
+            try {
+                if (slash == std::string::npos) {
+                    throw std::invalid_argument(value);
+                }
+                shard_index = static_cast<unsigned>(std::stoul(value.substr(0, slash)));
+                shard_count = static_cast<unsigned>(std::stoul(value.substr(slash + 1)));
+            } catch (const std::exception&) {
+                shard_count = 0;
+            }
+            if (shard_count == 0 || shard_index >= shard_count) {
+                std::cerr << "--shard needs <i>/<n> with i < n: " << value << std::endl;
+                return 1;
+            }
+        } else if (arg == "--rng" && i + 1 < argc) {
+            rng_name = argv[++i];
+        } else if (arg == "--trail" && i + 1 < argc) {
+            std::string value = argv[++i];
+            if (!parseTrail(value, trail)) {
+                std::cerr << "Invalid value for --trail: " << value << std::endl;
+                return 1;
+            }
+        } else if ((arg == "--seed" || arg == "--alpha" || arg == "--beta" || arg == "--max-active" ||
+                    arg == "--top" || arg == "--keys" || arg == "--plaintexts" || arg == "--reject-below" ||
+                    arg == "--rounds") &&
+                   i + 1 < argc) {
+            std::string value = argv[++i];
+            unsigned long long number = 0;
+            try {
+                number = std::stoull(value, nullptr, 0);
+            } catch (const std::exception&) {
+                std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+                return 1;
+            }
+            if (arg == "--seed") {
+                seed = number;
+            } else if (arg == "--alpha") {
+                alpha = number;
+            } else if (arg == "--beta") {
+                beta = number;
+            } else if (arg == "--max-active") {
+                max_active = static_cast<int>(std::min(number, 16ULL));
+            } else if (arg == "--keys") {
+                NUM_KEYS = static_cast<int>(std::min(std::max(number, 1ULL), 1000000ULL));
+            } else if (arg == "--plaintexts") {
+                N_PLAINTEXTS = static_cast<long long>(std::min(std::max(number, 1ULL), 1ULL << 62));
+            } else if (arg == "--reject-below") {
+                reject_weight = static_cast<int>(std::min(number, 64ULL));
+            } else if (arg == "--rounds") {
+                NUM_ROUNDS_CIPHER = static_cast<int>(std::min(std::max(number, 1ULL), 31ULL));
+            } else {
+                top_k = static_cast<size_t>(number);
+            }
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (histogram_mode && !trail.empty()) {
+        std::cerr << "--histogram and --trail cannot be combined." << std::endl;
+        return 1;
+    }
+    if (!trail.empty() && trail.size() != static_cast<size_t>(NUM_ROUNDS_CIPHER - 1)) {
+        std::cerr << "--trail needs " << NUM_ROUNDS_CIPHER - 1 << " comma separated differences for "
+                  << NUM_ROUNDS_CIPHER << " rounds." << std::endl;
+        return 1;
+    }
+    if (adaptive && (shard_count > 1 || !output_path.empty())) {
+        std::cerr << "--adaptive cannot be combined with --shard or --output." << std::endl;
+        return 1;
+    }
+    // The result file holds the right pairs of beta only
+    if (!output_path.empty() && (histogram_mode || !trail.empty())) {
+        std::cerr << "--output cannot be combined with --histogram or --trail." << std::endl;
+        return 1;
+    }
+    // Shard i covers keys [first_key, last_key)
+    const int first_key = static_cast<int>(static_cast<long long>(NUM_KEYS) * shard_index / shard_count);
+    const int last_key = static_cast<int>(static_cast<long long>(NUM_KEYS) * (shard_index + 1) / shard_count);
+    const int shard_keys = last_key - first_key;
+    // Trail mode targets: the intermediate differences, then beta after the last round
+    std::vector<uint64_t> round_targets = trail;
+    round_targets.push_back(beta);
+
+    // Key k draws from sub-stream k of the root generator: its key from
+    // sub-stream 0 and its plaintexts from sub-stream 1 of that
+    std::unique_ptr<Rng> root;
+    try {
+        root = Rng::create(rng_name, seed);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    const unsigned num_threads = defaultThreadCount();
+
+    std::cout << "Starting differential cryptanalysis experiment on " << NUM_ROUNDS_CIPHER << "-round PRESENT..." << std::endl;
     std::cout << "Parameters:" << std::endl;
     std::cout << "  Number of Keys (NUM_KEYS): " << NUM_KEYS << std::endl;
     std::cout << "  Number of Plaintexts per Key (N): " << N_PLAINTEXTS << std::endl;
     std::cout << "  Cipher Rounds: " << NUM_ROUNDS_CIPHER << std::endl;
-    std::cout << "  Alpha (Input Difference):  0x" << std::hex << std::setw(16) << std::setfill('0') << ALPHA << std::dec << std::endl;
-    std::cout << "  Beta (Output Difference): 0x" << std::hex << std::setw(16) << std::setfill('0') << BETA << std::dec << std::endl;
+    std::cout << "  Alpha (Input Difference):  0x" << std::hex << std::setw(16) << std::setfill('0') << alpha << std::dec << std::endl;
+    std::cout << "  Beta (Output Difference): 0x" << std::hex << std::setw(16) << std::setfill('0') << beta << std::dec << std::endl;
+    std::cout << "  Seed: 0x" << std::hex << std::setw(16) << std::setfill('0') << seed << std::dec << std::endl;
+    std::cout << "  Generator: " << rng_name << std::endl;
+    std::cout << "  Threads: " << num_threads << std::endl;
+    if (histogram_mode) {
+        std::cout << "  Histogram: output differences with at most " << max_active << " active nibbles, top " << top_k << std::endl;
+    }
+    if (!trail.empty()) {
+        std::cout << "  Trail:";
+        for (uint64_t d : trail) {
+            std::cout << " 0x" << std::hex << std::setw(16) << std::setfill('0') << d << std::dec;
+        }
+        std::cout << " (rounds 1 .. " << NUM_ROUNDS_CIPHER - 1 << ")" << std::endl;
+    }
+    if (shard_count > 1) {
+        std::cout << "  Shard: " << shard_index << "/" << shard_count << ", keys " << first_key << " .. "
+                  << last_key - 1 << std::endl;
+    }
+    if (!output_path.empty()) {
+        std::cout << "  Result file: " << output_path << ", checkpoint every " << checkpoint_seconds << " s" << std::endl;
+    }
+    if (adaptive) {
+        std::cout << "  Adaptive: stop at relative error " << rel_error << " or below 2^-" << reject_weight
+                  << " (95% interval), at most N plaintexts per key" << std::endl;
+    }
+    if (telemetry_seconds > 0.0 || !telemetry_path.empty()) {
+        std::cout << "  Telemetry: every " << (telemetry_seconds > 0.0 ? telemetry_seconds : DEFAULT_TELEMETRY_SECONDS)
+                  << " s" << (telemetry_path.empty() ? "" : ", exported to " + telemetry_path) << std::endl;
+    }
     std::cout << "--------------------------------------------------" << std::endl;
 
-    std::vector<long long> counters(NUM_KEYS, 0);
     // Assuming 80-bit key for PRESENT, as it's a common default.
-    // The Present class constructor defaults to KeySize::KEY_80.
-    Present cipher(Present::KeySize::KEY_80, NUM_ROUNDS_CIPHER);
+    const size_t key_length_bytes = static_cast<size_t>(Present::KeySize::KEY_80) / 8;
+    std::vector<std::vector<uint8_t>> keys(NUM_KEYS);
+    std::vector<std::unique_ptr<Rng>> key_streams(NUM_KEYS);
+    for (int k = first_key; k < last_key; ++k) {
+        key_streams[k] = root->split(k);
+        keys[k] = deriveKey(*key_streams[k], key_length_bytes);
+    }
 
-    for (int k = 0; k < NUM_KEYS; ++k) {
-        std::cout << "Processing Key " << std::setw(3) << std::setfill(' ') << k + 1 << "/" << NUM_KEYS << "..." << std::endl;
-        std::vector<uint8_t> current_key_bytes = cipher.generateRandomKey();
+    // Counters of the shard's keys: plaintexts counted so far and the right
+    // pairs among them from a resumed result file, plus the workers' counters
+    std::vector<long long> done(NUM_KEYS, 0);
+    std::vector<long long> resumed(NUM_KEYS, 0);
+    ExperimentResult result;
+    result.rounds = static_cast<uint32_t>(NUM_ROUNDS_CIPHER);
+    result.alpha = alpha;
+    result.beta = beta;
+    result.seed = seed;
+    result.rng = rng_name;
+    result.plaintextsPerKey = static_cast<uint64_t>(N_PLAINTEXTS);
+    result.totalKeys = static_cast<uint32_t>(NUM_KEYS);
+    result.firstKey = static_cast<uint32_t>(first_key);
+    if (!output_path.empty() && std::ifstream(output_path).good()) {
         try {
-            cipher.setKey(current_key_bytes.data(), current_key_bytes.size());
-        } catch (const std::exception& e) {
-            std::cerr << "Error setting key " << k + 1 << ": " << e.what() << ". Skipping this key." << std::endl;
-            continue; // Skip to the next key
+            ExperimentResult previous = readResultFile(output_path);
+            if (!previous.sameExperiment(result) || previous.firstKey != result.firstKey ||
+                previous.done.size() != static_cast<size_t>(shard_keys)) {
+                std::cerr << output_path << " belongs to another experiment or shard; remove it to start over."
+                          << std::endl;
+                return 1;
+            }
+            long long total_done = 0;
+            for (int k = first_key; k < last_key; ++k) {
+                done[k] = static_cast<long long>(previous.done[k - first_key]);
+                resumed[k] = static_cast<long long>(previous.hits[k - first_key]);
+                total_done += done[k];
+            }
+            std::cout << "Resuming from " << output_path << ": " << total_done << " of "
+                      << static_cast<long long>(shard_keys) * N_PLAINTEXTS << " plaintexts counted" << std::endl;
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
         }
+    }
 
-        long long report_interval = N_PLAINTEXTS / 10;
-        if (report_interval == 0) report_interval = 1; // Avoid division by zero if N_PLAINTEXTS < 10
+    std::vector<WorkerState> workers(num_threads, WorkerState(max_active));
+    std::vector<std::atomic<long long>> tasks_left(NUM_KEYS);
+    for (auto& c : tasks_left) {
+        c = 0;
+    }
+    std::mutex output_mutex;
 
-        for (long long i = 0; i < N_PLAINTEXTS; ++i) {
-            if (((i + 1) % report_interval == 0 && N_PLAINTEXTS >= 10) || (i + 1) == N_PLAINTEXTS) {
-                 std::cout << "  Key " << std::setw(3) << std::setfill(' ') << k + 1
-                           << ": Processed " << std::setw(9) << std::setfill(' ') << i + 1 << "/" << N_PLAINTEXTS << " plaintexts ("
-                           << std::fixed << std::setprecision(1) << (static_cast<double>(i + 1) / N_PLAINTEXTS * 100.0)
-                           << "%)" << std::endl;
+    // Null unless asked for, so a disabled run pays one test per task
+    std::unique_ptr<Telemetry> telemetry;
+    if (telemetry_seconds > 0.0 || !telemetry_path.empty()) {
+        telemetry.reset(new Telemetry(num_threads, static_cast<size_t>(first_key), static_cast<size_t>(last_key)));
+        for (int k = first_key; k < last_key; ++k) {
+            telemetry->addKeyTrials(static_cast<size_t>(k), static_cast<uint64_t>(done[k]));
+        }
+        telemetry->start(telemetry_seconds > 0.0 ? telemetry_seconds : DEFAULT_TELEMETRY_SECONDS,
+                         telemetry_seconds > 0.0 ? &std::cerr : nullptr, telemetry_path);
+    }
+    // Queue the pairs of a task list with the telemetry, if any
+    auto planTasks = [&](const std::vector<Task>& tasks, long long perKey) {
+        if (telemetry) {
+            uint64_t pairs = 0;
+            for (const Task& task : tasks) {
+                pairs += static_cast<uint64_t>(task.end - task.begin);
             }
+            telemetry->plan(pairs, static_cast<uint64_t>(perKey));
+        }
+    };
 
-            uint64_t p_i = Present::generateRandomPlaintext();
-            uint64_t p_i_star = p_i ^ ALPHA;
+    std::vector<long long> counters(NUM_KEYS, 0);
+    auto sumCounters = [&]() {
+        std::copy(resumed.begin(), resumed.end(), counters.begin());
+        for (const auto& state : workers) {
+            for (int k = first_key; k < last_key; ++k) {
+                counters[k] += state.counters[k];
+            }
+        }
+        return std::accumulate(counters.begin(), counters.end(), 0LL);
+    };
 
-            uint64_t enc_p_i = 0;
-            uint64_t enc_p_i_star = 0;
+    // Tasks [t0, t1) of a list, in parallel. With report_keys a key is
+    // reported once the last of its tasks in the list is done.
+    auto runTasks = [&](const std::vector<Task>& tasks, size_t t0, size_t t1, bool report_keys) {
+        parallelFor(t1 - t0, num_threads, [&](size_t index, unsigned w) {
+            const Task& task = tasks[t0 + index];
+            const int k = task.key;
+            WorkerState& state = workers[w];
 
-            try {
-                enc_p_i = cipher.encrypt(p_i);
-                enc_p_i_star = cipher.encrypt(p_i_star);
-            } catch (const std::runtime_error& e) {
-                std::cerr << "Runtime error during encryption for key " << k+1 << ", plaintext " << i+1
-                          << ": " << e.what() << ". Skipping this plaintext pair." << std::endl;
-                continue; // Skip this plaintext pair
+            if (state.currentKey != k) {
+                state.cipher.setKey(keys[k].data(), keys[k].size());
+                state.currentKey = k;
             }
 
-            uint64_t output_diff = enc_p_i ^ enc_p_i_star;
+            // Jump to this chunk's position in the key's plaintext stream, so the
+            // plaintexts do not depend on the chunk size, the batches or the thread
+            std::unique_ptr<Rng> gen = key_streams[k]->split(1);
+            gen->discard(static_cast<uint64_t>(task.begin));
+            const long long n = task.end - task.begin;
+
+            Present::CountProfile profile;
+            Present::CountProfile* task_profile = telemetry ? &profile : nullptr;
+            long long hits = 0;
+            if (histogram_mode) {
+                hits = countWithHistogram(state, *gen, n, alpha, beta, task_profile);
+            } else if (!trail.empty()) {
+                // Every prefix of the characteristic from the same pairs
+                state.cipher.countDifferentialRounds(alpha, round_targets.data(), static_cast<uint64_t>(n),
+                                                     *gen, state.roundHits.data(), Present::Engine::Auto,
+                                                     task_profile);
+                for (int r = 0; r < NUM_ROUNDS_CIPHER; ++r) {
+                    state.roundCounters[r] += state.roundHits[r];
+                }
+                hits = static_cast<long long>(state.roundHits[NUM_ROUNDS_CIPHER - 1]);
+            } else {
+                hits = static_cast<long long>(state.cipher.countDifferential(
+                    alpha, beta, static_cast<uint64_t>(n), *gen, Present::Engine::Auto, task_profile));
+            }
+            state.counters[k] += hits;
+            if (telemetry) {
+                telemetry->worker(w).addTask(static_cast<uint64_t>(n), static_cast<uint64_t>(hits), profile.rngNanos,
+                                             profile.encryptNanos, profile.compareNanos);
+                telemetry->addKeyTrials(static_cast<size_t>(k), static_cast<uint64_t>(n));
+            }
 
-            if (output_diff == BETA) {
-                counters[k]++;
+            if (report_keys && tasks_left[k].fetch_sub(1) == 1) {
+                long long key_total = resumed[k];
+                for (const auto& other : workers) {
+                    key_total += other.counters[k];
+                }
+                std::lock_guard<std::mutex> guard(output_mutex);
+                std::cout << "  Key " << std::setw(3) << std::setfill(' ') << k + 1 << " finished. Counter C[" << k << "] = " << key_total << std::endl;
             }
+        });
+    };
+
+    long long n_used = 0; // Plaintexts per key counted so far
+    std::string stop_reason;
+    if (!adaptive) {
+        const std::vector<Task> tasks = makeTasks(first_key, last_key, done, N_PLAINTEXTS);
+        for (const Task& task : tasks) {
+            ++tasks_left[task.key];
+        }
+        planTasks(tasks, N_PLAINTEXTS);
+        if (output_path.empty()) {
+            runTasks(tasks, 0, tasks.size(), true);
+        } else {
+            // Steps of whole tasks, sized to take about checkpoint_seconds;
+            // the result file is rewritten after each
+            size_t step = 4 * static_cast<size_t>(num_threads);
+            size_t t = 0;
+            do {
+                const size_t t1 = std::min(t + step, tasks.size());
+                auto start = std::chrono::steady_clock::now();
+                runTasks(tasks, t, t1, true);
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                for (; t < t1; ++t) {
+                    done[tasks[t].key] = tasks[t].end;
+                }
+
+                sumCounters();
+                result.done.assign(done.begin() + first_key, done.begin() + last_key);
+                result.hits.assign(counters.begin() + first_key, counters.begin() + last_key);
+                try {
+                    writeResultFile(output_path, result);
+                } catch (const std::runtime_error& e) {
+                    std::cerr << e.what() << std::endl;
+                    return 1;
+                }
+                const double scale = checkpoint_seconds / std::max(elapsed.count(), 1e-3);
+                step = static_cast<size_t>(std::min(std::max(step * scale, 1.0), 1e9));
+            } while (t < tasks.size());
         }
-        std::cout << "  Key " << std::setw(3) << std::setfill(' ') << k + 1 << " finished. Counter C[" << k << "] = " << counters[k] << std::endl;
+        n_used = N_PLAINTEXTS;
+    } else {
+        // Every batch doubles the plaintexts per key, so the intervals are
+        // checked O(log N) times and a stopped run is a prefix of a full one
+        for (long long to = std::min(ADAPTIVE_FIRST_BATCH, N_PLAINTEXTS);; to = std::min(2 * to, N_PLAINTEXTS)) {
+            const std::vector<Task> tasks = makeTasks(first_key, last_key, done, to);
+            planTasks(tasks, to);
+            runTasks(tasks, 0, tasks.size(), false);
+            std::fill(done.begin() + first_key, done.begin() + last_key, to);
+            n_used = to;
+            const long long hits = sumCounters();
+            const BinomialInterval ci =
+                wilsonInterval(static_cast<uint64_t>(hits), static_cast<uint64_t>(shard_keys) * n_used);
+            std::cout << "  N = " << std::setw(11) << std::setfill(' ') << n_used << " per key: "
+                      << std::setw(9) << hits << " hits, P in [" << log2String(ci.low) << ", "
+                      << log2String(ci.high) << "]" << std::endl;
+            if (ci.relativeError() <= rel_error) {
+                stop_reason = "relative error reached";
+                break;
+            }
+            if (ci.high < std::ldexp(1.0, -reject_weight)) {
+                stop_reason = "rejected, P below 2^-" + std::to_string(reject_weight);
+                break;
+            }
+            if (n_used >= N_PLAINTEXTS) {
+                stop_reason = "plaintext limit reached";
+                break;
+            }
+        }
+    }
+    sumCounters();
+    if (telemetry) {
+        telemetry->stop();
     }
 
     std::cout << "--------------------------------------------------" << std::endl;
     std::cout << "Experiment Results:" << std::endl;
-    std::cout << "N (Plaintexts per key chosen): " << N_PLAINTEXTS << std::endl;
-    std::cout << "Counters C_i for each of the " << NUM_KEYS << " keys:" << std::endl;
-    for (int k = 0; k < NUM_KEYS; ++k) {
-        std::cout << "C[" << std::setw(2) << std::setfill(' ') << k << "]: " << counters[k] << std::endl;
+    std::cout << "N (Plaintexts per key chosen): " << n_used << std::endl;
+    if (adaptive) {
+        std::cout << "Adaptive sampling stopped: " << stop_reason << std::endl;
+    }
+    std::cout << "Counters C_i for each of the " << shard_keys << " keys:" << std::endl;
+    for (int k = first_key; k < last_key; ++k) {
+        std::cout << "C[" << std::setw(2) << std::setfill(' ') << k << "]: " << counters[k];
+        if (adaptive) {
+            const BinomialInterval ci =
+                wilsonInterval(static_cast<uint64_t>(counters[k]), static_cast<uint64_t>(n_used));
+            std::cout << "  P in [" << log2String(ci.low) << ", " << log2String(ci.high) << "]";
+        }
+        std::cout << std::endl;
     }
 
     long long total_successes = std::accumulate(counters.begin(), counters.end(), 0LL);
-    long long total_trials = static_cast<long long>(NUM_KEYS) * N_PLAINTEXTS;
+    long long total_trials = static_cast<long long>(shard_keys) * n_used;
 
     std::cout << "Total successes (sum of all C_i): " << total_successes << std::endl;
     std::cout << "Total trials (NUM_KEYS * N): " << total_trials << std::endl;
@@ -101,7 +580,7 @@ int main(int argc, char* argv[]) {
 
     if (total_successes == 0) {
         std::cout << "No successes observed. Experimental probability is effectively 0." << std::endl;
-        std::cout << "Cannot express as 2^(-x.xx) because probability is 0 or too small to measure with N=" << N_PLAINTEXTS << " per key." << std::endl;
+        std::cout << "Cannot express as 2^(-x.xx) because probability is 0 or too small to measure with N=" << n_used << " per key." << std::endl;
     } else {
         double experimental_probability = static_cast<double>(total_successes) / total_trials;
         std::cout << "Experimental Probability (P_exp = Total_Successes / Total_Trials): "
@@ -111,6 +590,55 @@ int main(int argc, char* argv[]) {
         std::cout << "Experimental Probability (P_exp expressed as 2^(-x.xx)): 2^(-"
                   << std::fixed << std::setprecision(2) << x << ")" << std::endl;
     }
+    if (total_trials > 0) {
+        const BinomialInterval ci =
+            wilsonInterval(static_cast<uint64_t>(total_successes), static_cast<uint64_t>(total_trials));
+        std::cout << "95% confidence interval (Wilson): [" << log2String(ci.low) << ", " << log2String(ci.high) << "]";
+        if (total_successes > 0) {
+            std::cout << ", relative error " << std::fixed << std::setprecision(1) << 100.0 * ci.relativeError() << "%";
+        }
+        std::cout << std::endl;
+    }
+
+    if (!trail.empty()) {
+        std::vector<uint64_t> round_counters(NUM_ROUNDS_CIPHER, 0);
+        for (const auto& state : workers) {
+            for (int r = 0; r < NUM_ROUNDS_CIPHER; ++r) {
+                round_counters[r] += state.roundCounters[r];
+            }
+        }
+
+        std::cout << "--------------------------------------------------" << std::endl;
+        std::cout << "Right pairs after every round (alpha -> difference after round r):" << std::endl;
+        for (int r = 0; r < NUM_ROUNDS_CIPHER; ++r) {
+            std::cout << "  Round " << r + 1 << ": 0x" << std::hex << std::setw(16) << std::setfill('0')
+                      << round_targets[r] << std::dec << "  count " << std::setw(12) << std::setfill(' ')
+                      << round_counters[r];
+            if (round_counters[r] > 0) {
+                double probability = static_cast<double>(round_counters[r]) / total_trials;
+                std::cout << "  P = 2^(-" << std::fixed << std::setprecision(2)
+                          << std::max(0.0, -log2(probability)) << ")";
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    if (histogram_mode) {
+        DifferenceHistogram& histogram = workers[0].histogram;
+        for (size_t w = 1; w < workers.size(); ++w) {
+            histogram.merge(workers[w].histogram);
+        }
+
+        std::cout << "--------------------------------------------------" << std::endl;
+        std::cout << "Most frequent output differences (at most " << max_active << " active nibbles, "
+                  << histogram.size() << " distinct):" << std::endl;
+        for (const auto& entry : histogram.top(top_k)) {
+            double probability = static_cast<double>(entry.second) / total_trials;
+            std::cout << "  0x" << std::hex << std::setw(16) << std::setfill('0') << entry.first << std::dec
+                      << "  count " << std::setw(10) << std::setfill(' ') << entry.second
+                      << "  P = 2^(-" << std::fixed << std::setprecision(2) << -log2(probability) << ")" << std::endl;
+        }
+    }
     std::cout << "--------------------------------------------------" << std::endl;
     std::cout << "Experiment finished." << std::endl;
 
@@ -0,0 +1,275 @@
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include "present.hh"
+#include "present_core.hh"
+#include "sbox_tables.hh"
+#include "difference_map.hh"
+#include "nibble_activity.hh"
+#include "thread_pool.hh"
+#include "probability_format.hh"
+
+// Probability of a differential (alpha -> beta) over r rounds of PRESENT,
+// summed over all the trails between them (the differential effect), under
+// the usual assumption of independent round keys.
+//
+// A sparse vector of difference probabilities is propagated round by round:
+// every entry is expanded over all S-box transitions of its active nibbles
+// (DDT[a][b] / 16 each) and mapped through the pLayer. Differences with more
+// than --max-active active nibbles or a probability below 2^-threshold are
+// dropped, so the result is a lower bound; the mass dropped is reported.
+// The last round is not expanded: the probability of reaching beta from each
+// entry is a product of DDT entries, read off directly.
+//
+// Each round is split into ranges of hash table slots, expanded in parallel
+// into one map per worker and merged.
+
+const int DEFAULT_NUM_KEYS = 100; // differential_experiment's defaults, for the expected right pairs
+const long long DEFAULT_N_PLAINTEXTS = 1LL << 25;
+const size_t SLOT_RANGES = 256; // Parallel tasks per round
+
+// Transitions from each input nibble difference, most likely first
+struct Transitions {
+    struct Entry {
+        uint64_t out;
+        double p;
+    };
+    std::vector<Entry> from[16];
+};
+
+Transitions buildTransitions() {
+    Transitions t;
+    for (int a = 1; a < 16; ++a) {
+        for (int b = 1; b < 16; ++b) {
+            if (DDT.entry[a][b] != 0) {
+                t.from[a].push_back({static_cast<uint64_t>(b), DDT.entry[a][b] / 16.0});
+            }
+        }
+        std::sort(t.from[a].begin(), t.from[a].end(),
+                  [](const Transitions::Entry& x, const Transitions::Entry& y) { return x.p > y.p; });
+    }
+    return t;
+}
+
+struct Limits {
+    int maxActive;
+    double minProbability;
+    double maxTransition; // Largest DDT probability of a non-zero transition
+};
+
+// Per-thread output of a round
+struct WorkerState {
+    DifferenceMap next;
+    double dropped = 0.0;
+};
+
+// Expand the active nibbles in pending of one entry; sboxOut collects the chosen outputs
+void expand(const Transitions& t, const Limits& limits, uint64_t diff, uint64_t pending,
+            uint64_t sboxOut, double p, WorkerState& state) {
+    if (pending == 0) {
+        const uint64_t out = present_detail::pLayerShift(sboxOut);
+        if (p < limits.minProbability || activeNibbles(out) > limits.maxActive) {
+            state.dropped += p;
+        } else {
+            state.next.add(out, p);
+        }
+        return;
+    }
+
+    const int bit = __builtin_ctzll(pending);
+    pending &= pending - 1;
+    // The remaining nibbles can only lower p further: drop the whole subtree
+    // once even the most likely completion falls below the threshold
+    const double best_rest = std::pow(limits.maxTransition, __builtin_popcountll(pending));
+    for (const Transitions::Entry& e : t.from[(diff >> bit) & 0xF]) {
+        const double q = p * e.p;
+        if (q * best_rest < limits.minProbability) {
+            state.dropped += q;
+            continue;
+        }
+        expand(t, limits, diff, pending, sboxOut | (e.out << bit), q, state);
+    }
+}
+
+// Probability that difference diff entering the last round leaves it as beta
+double lastRound(uint64_t diff, uint64_t betaSboxOut) {
+    const uint64_t active = activeMask(diff);
+    if (active != activeMask(betaSboxOut)) {
+        return 0.0;
+    }
+    double p = 1.0;
+    for (uint64_t pending = active; pending != 0; pending &= pending - 1) {
+        const int bit = __builtin_ctzll(pending);
+        p *= DDT.entry[(diff >> bit) & 0xF][(betaSboxOut >> bit) & 0xF] / 16.0;
+    }
+    return p;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--alpha <diff>] [--beta <diff>] [--rounds <r>]"
+              << " [--max-active <k>] [--threshold <t>] [--threads <n>] [--top <K>] [--keys <k>] [--plaintexts <n>]"
+              << std::endl;
+    std::cerr << "  Differences with more than k active nibbles (default 3) or a probability below" << std::endl;
+    std::cerr << "  2^-t (default 40) are dropped. --top K lists the K likeliest output differences." << std::endl;
+    std::cerr << "  --keys and --plaintexts size the differential_experiment run whose right pairs are predicted" << std::endl;
+    std::cerr << "  (default " << DEFAULT_NUM_KEYS << " keys x 2^25 pairs, as in differential_experiment)." << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+
+    uint64_t alpha = 0x0000000000004004ULL; // Defaults of differential_experiment
+    uint64_t beta = alpha;
+    int rounds = 4;
+    int max_active = 3;
+    int threshold = 40;
+    size_t top_k = 0;
+    unsigned num_threads = defaultThreadCount();
+    int num_keys = DEFAULT_NUM_KEYS;
+    long long n_plaintexts = DEFAULT_N_PLAINTEXTS;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "--alpha" || arg == "--beta" || arg == "--rounds" || arg == "--max-active" ||
+             arg == "--threshold" || arg == "--threads" || arg == "--top" || arg == "--keys" ||
+             arg == "--plaintexts") && i + 1 < argc) {
+            std::string value = argv[++i];
+            unsigned long long number = 0;
+            try {
+                number = std::stoull(value, nullptr, 0);
+            } catch (const std::exception&) {
+                std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+                return 1;
+            }
+            if (arg == "--alpha") {
+                alpha = number;
+            } else if (arg == "--beta") {
+                beta = number;
+            } else if (arg == "--rounds") {
+                rounds = static_cast<int>(std::min(std::max(number, 1ULL), 31ULL));
+            } else if (arg == "--max-active") {
+                max_active = static_cast<int>(std::min(std::max(number, 1ULL), 16ULL));
+            } else if (arg == "--threshold") {
+                threshold = static_cast<int>(std::min(number, 1000ULL));
+            } else if (arg == "--threads") {
+                num_threads = number == 0 ? defaultThreadCount() : static_cast<unsigned>(number);
+            } else if (arg == "--keys") {
+                num_keys = static_cast<int>(std::min(std::max(number, 1ULL), 1000000ULL));
+            } else if (arg == "--plaintexts") {
+                n_plaintexts = static_cast<long long>(std::min(std::max(number, 1ULL), 1ULL << 62));
+            } else {
+                top_k = static_cast<size_t>(number);
+            }
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (alpha == 0 || beta == 0) {
+        std::cerr << "alpha and beta must be non-zero." << std::endl;
+        return 1;
+    }
+
+    const Transitions transitions = buildTransitions();
+    Limits limits;
+    limits.maxActive = max_active;
+    limits.minProbability = std::ldexp(1.0, -threshold);
+    limits.maxTransition = 0.0;
+    for (const auto& list : transitions.from) {
+        for (const auto& e : list) {
+            limits.maxTransition = std::max(limits.maxTransition, e.p);
+        }
+    }
+
+    std::cout << "Differential probability of PRESENT by sparse propagation" << std::endl;
+    std::cout << "  Alpha: 0x" << std::hex << std::setw(16) << std::setfill('0') << alpha << std::dec << std::endl;
+    std::cout << "  Beta:  0x" << std::hex << std::setw(16) << std::setfill('0') << beta << std::dec << std::endl;
+    std::cout << "  Rounds: " << rounds << ", at most " << max_active << " active nibbles, threshold 2^-"
+              << threshold << ", threads: " << num_threads << std::endl;
+    std::cout << "--------------------------------------------------" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    DifferenceMap current;
+    current.add(alpha, 1.0);
+    double dropped_total = 0.0;
+    std::vector<WorkerState> workers(num_threads);
+
+    // One round of propagation, in parallel over ranges of slots
+    auto propagate = [&](int round) {
+        for (auto& state : workers) {
+            state.next.clear();
+            state.dropped = 0.0;
+        }
+        const size_t slots = current.slotCount();
+        const size_t ranges = std::min(SLOT_RANGES, slots);
+        parallelFor(ranges, num_threads, [&](size_t task, unsigned w) {
+            WorkerState& state = workers[w];
+            current.forEach(slots * task / ranges, slots * (task + 1) / ranges, [&](uint64_t diff, double p) {
+                expand(transitions, limits, diff, activeMask(diff), 0, p, state);
+            });
+        });
+
+        DifferenceMap next;
+        double dropped = 0.0;
+        for (const auto& state : workers) {
+            next.merge(state.next);
+            dropped += state.dropped;
+        }
+        dropped_total += dropped;
+        std::swap(current, next);
+
+        double kept = 0.0;
+        current.forEach(0, current.slotCount(), [&kept](uint64_t, double p) { kept += p; });
+        std::cout << "  Round " << std::setw(2) << std::setfill(' ') << round << ": "
+                  << std::setw(9) << current.size() << " differences, mass kept " << log2String(kept)
+                  << ", dropped " << log2String(dropped) << std::endl;
+    };
+
+    // Rounds 1 .. rounds - 1 are expanded; the last one is evaluated for beta only
+    for (int round = 1; round < rounds; ++round) {
+        propagate(round);
+    }
+    double probability = 0.0;
+    const uint64_t beta_sbox_out = present_detail::invPLayerShift(beta);
+    current.forEach(0, current.slotCount(), [&](uint64_t diff, double p) {
+        probability += p * lastRound(diff, beta_sbox_out);
+    });
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "--------------------------------------------------" << std::endl;
+    std::cout << "P(alpha -> beta) >= " << std::scientific << std::setprecision(6) << probability
+              << " = " << log2String(probability) << std::endl;
+    std::cout << "Expected right pairs over " << num_keys << " keys x " << n_plaintexts << " pairs: "
+              << std::fixed << std::setprecision(1) << probability * num_keys * static_cast<double>(n_plaintexts)
+              << std::endl;
+    std::cout << "Mass dropped by the limits: " << log2String(dropped_total) << std::endl;
+
+    if (top_k > 0) {
+        // The last round in full, under the same limits
+        propagate(rounds);
+        std::vector<std::pair<uint64_t, double>> entries;
+        current.forEach(0, current.slotCount(), [&entries](uint64_t diff, double p) {
+            entries.emplace_back(diff, p);
+        });
+        top_k = std::min(top_k, entries.size());
+        std::partial_sort(entries.begin(), entries.begin() + top_k, entries.end(),
+                          [](const std::pair<uint64_t, double>& a, const std::pair<uint64_t, double>& b) {
+                              return a.second != b.second ? a.second > b.second : a.first < b.first;
+                          });
+        std::cout << "Likeliest output differences:" << std::endl;
+        for (size_t i = 0; i < top_k; ++i) {
+            std::cout << "  0x" << std::hex << std::setw(16) << std::setfill('0') << entries[i].first << std::dec
+                      << "  P = " << log2String(entries[i].second) << std::endl;
+        }
+    }
+    std::cout << "Time: " << std::fixed << std::setprecision(3) << elapsed.count() << " s"
+              << (top_k > 0 ? " (before the output list)" : "") << std::endl;
+    return 0;
+}
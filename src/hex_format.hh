@@ -0,0 +1,64 @@
+/*
+ * File: hex_format.hh
+ *
+ * Description:    Hex strings on the command line and in reports
+ *
+ * Keys, IVs and key differences are given as plain hex digits, two per byte
+ * in key byte order; differences and seeds are printed as 16-digit 0x
+ * values.
+ *
+ * Copyright (c) 2025 Ahmet Çobanoğlu
+ * All rights reserved.
+ *
+ * This file is proprietary and confidential. Unauthorized copying, distribution,
+ * modification, or use of this file, via any medium, is strictly prohibited
+ * without express written permission from the copyright holder.
+ */
+
+#ifndef D0481BF1_7288_49A5_BC2B_61E10EBA7FDF
+#define D0481BF1_7288_49A5_BC2B_61E10EBA7FDF
+
+#include <cctype>
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Bytes of a string of hex digits, two digits per byte
+ *
+ * Only hex digits are accepted: no prefix, sign or whitespace, which
+ * strtoul() would otherwise let through as a different value.
+ *
+ * @throws std::invalid_argument for an odd number of digits or a non-hex character
+ */
+inline std::vector<uint8_t> parseHex(const std::string& hex)
+{
+    if (hex.size() % 2 != 0) {
+        throw std::invalid_argument("Odd number of hex digits: " + hex);
+    }
+    std::vector<uint8_t> bytes(hex.size() / 2);
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        const std::string pair = hex.substr(2 * i, 2);
+        if (!std::isxdigit(static_cast<unsigned char>(pair[0])) ||
+            !std::isxdigit(static_cast<unsigned char>(pair[1]))) {
+            throw std::invalid_argument("Invalid hex digits: " + pair);
+        }
+        bytes[i] = static_cast<uint8_t>(std::stoul(pair, nullptr, 16));
+    }
+    return bytes;
+}
+
+/**
+ * @brief A 64-bit value as 0x followed by 16 hex digits
+ */
+inline std::string hex64(uint64_t value)
+{
+    std::ostringstream out;
+    out << "0x" << std::hex << std::setw(16) << std::setfill('0') << value;
+    return out.str();
+}
+
+#endif /* D0481BF1_7288_49A5_BC2B_61E10EBA7FDF */
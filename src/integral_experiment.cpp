@@ -0,0 +1,293 @@
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <iomanip>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+
+#include "present.hh"
+#include "present_rng.hh"
+#include "thread_pool.hh"
+
+// Integral (square) counterpart of differential_experiment: structured sets
+// of 2^k plaintexts, the chosen nibbles taking every value and the others a
+// random constant, are encrypted under reduced-round PRESENT and the XOR of
+// all ciphertexts of each set is recorded. An output bit whose sum is zero in
+// every set of every key is balanced; a random bit passes one set with
+// probability 1/2, so T sets leave a false positive with probability 2^-T.
+//
+// Each set is enumerated in Gray-code order, so the next plaintext is one XOR
+// away from the last, in batches through Present::encryptBlocks. The sums are
+// XORed in four independent registers per batch. Large sets are split into
+// chunks of CHUNK_PLAINTEXTS that run on all cores; the partial sums of each
+// worker are combined at the end, so the result does not depend on the
+// chunking or the thread count. Key k and the constants of its sets come from
+// sub-streams 0 and 1 of sub-stream k of the seeded generator.
+
+// Constants
+const uint64_t DEFAULT_SEED = 0x50524553454E5421ULL;
+const uint64_t DEFAULT_ACTIVE = 0x000F; // Active nibbles 0 .. 3, 2^16 plaintexts per set
+const uint64_t CHUNK_PLAINTEXTS = 1ULL << 20; // Plaintexts per parallel task
+const size_t BATCH = 4096;                    // Plaintexts encrypted at a time
+const int MAX_ACTIVE_BITS = 32;
+
+// XOR of the ciphertexts of the Gray-code indices [begin, end) of a set.
+// toggles[i] is the plaintext bit flipped when index bit i changes, with a
+// zero entry past the last active bit for the step out of the set.
+uint64_t xorSumPart(const Present& cipher, uint64_t constant, const std::vector<uint64_t>& toggles,
+                    uint64_t begin, uint64_t end, std::vector<uint64_t>& buffer) {
+    // Plaintext of index begin: its Gray code spread over the active bits
+    uint64_t p = constant;
+    const uint64_t gray = begin ^ (begin >> 1);
+    for (size_t i = 0; i + 1 < toggles.size(); ++i) {
+        if ((gray >> i) & 1) {
+            p ^= toggles[i];
+        }
+    }
+
+    uint64_t acc0 = 0, acc1 = 0, acc2 = 0, acc3 = 0;
+    for (uint64_t j = begin; j < end;) {
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(BATCH, end - j));
+        for (size_t i = 0; i < count; ++i, ++j) {
+            buffer[i] = p;
+            // Gray code: index j + 1 differs from j in bit ctz(j + 1)
+            p ^= toggles[__builtin_ctzll(j + 1)];
+        }
+        cipher.encryptBlocks(buffer.data(), buffer.data(), count);
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            acc0 ^= buffer[i];
+            acc1 ^= buffer[i + 1];
+            acc2 ^= buffer[i + 2];
+            acc3 ^= buffer[i + 3];
+        }
+        for (; i < count; ++i) {
+            acc0 ^= buffer[i];
+        }
+    }
+    return acc0 ^ acc1 ^ acc2 ^ acc3;
+}
+
+// Per-thread state: a private cipher per round count and the partial sums of every set
+struct WorkerState {
+    WorkerState(int firstRounds, int lastRounds, size_t numSums)
+        : currentKey(lastRounds - firstRounds + 1, -1), sums(numSums, 0), buffer(BATCH) {
+        for (int r = firstRounds; r <= lastRounds; ++r) {
+            ciphers.emplace_back(Present::KeySize::KEY_80, r);
+        }
+    }
+
+    std::vector<Present> ciphers;   // One per round count
+    std::vector<int> currentKey;    // Key index loaded into each cipher
+    std::vector<uint64_t> sums;     // Partial XOR sums, per (round count, key, set)
+    std::vector<uint64_t> buffer;   // Plaintext batch
+};
+
+// "4" or "3-6"
+bool parseRounds(const std::string& value, int& first, int& last) {
+    try {
+        const size_t dash = value.find('-');
+        first = std::stoi(value.substr(0, dash));
+        last = dash == std::string::npos ? first : std::stoi(value.substr(dash + 1));
+    } catch (const std::exception&) {
+        return false;
+    }
+    return first >= 1 && first <= last && last <= 31;
+}
+
+// Integral property notation, nibble 15 first: B balanced in every set, ? otherwise
+std::string balancePattern(uint64_t balanced) {
+    std::string out;
+    for (int nibble = 15; nibble >= 0; --nibble) {
+        for (int bit = 3; bit >= 0; --bit) {
+            out += ((balanced >> (4 * nibble + bit)) & 1) ? 'B' : '?';
+        }
+        if (nibble > 0) {
+            out += ' ';
+        }
+    }
+    return out;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--active <nibble mask>] [--rounds <r>|<r1>-<r2>] [--keys <k>]"
+              << " [--sets <s>] [--seed <value>] [--rng splitmix|philox|present-ctr]" << std::endl;
+    std::cerr << "  Bit i of --active makes nibble i active (default 0x000f, 2^16 plaintexts per set, at most"
+              << " 2^32)." << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+
+    uint64_t active = DEFAULT_ACTIVE;
+    int first_rounds = 6;
+    int last_rounds = 6;
+    int num_keys = 16;
+    int num_sets = 4; // Sets per key, each with its own constant
+    uint64_t seed = DEFAULT_SEED;
+    std::string rng_name = "splitmix";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--rng" && i + 1 < argc) {
+            rng_name = argv[++i];
+        } else if (arg == "--rounds" && i + 1 < argc) {
+            std::string value = argv[++i];
+            if (!parseRounds(value, first_rounds, last_rounds)) {
+                std::cerr << "Invalid value for --rounds: " << value << std::endl;
+                return 1;
+            }
+        } else if ((arg == "--active" || arg == "--keys" || arg == "--sets" || arg == "--seed") && i + 1 < argc) {
+            std::string value = argv[++i];
+            unsigned long long number = 0;
+            try {
+                number = std::stoull(value, nullptr, 0);
+            } catch (const std::exception&) {
+                std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+                return 1;
+            }
+            if (arg == "--active") {
+                active = number;
+            } else if (arg == "--keys") {
+                num_keys = static_cast<int>(std::min(std::max(number, 1ULL), 100000ULL));
+            } else if (arg == "--sets") {
+                num_sets = static_cast<int>(std::min(std::max(number, 1ULL), 100000ULL));
+            } else {
+                seed = number;
+            }
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (active == 0 || active > 0xFFFF || 4 * __builtin_popcountll(active) > MAX_ACTIVE_BITS) {
+        std::cerr << "--active needs 1 to " << MAX_ACTIVE_BITS / 4 << " of the 16 nibbles." << std::endl;
+        return 1;
+    }
+
+    // Plaintext bits flipped by each Gray-code index bit, the active bits in order
+    std::vector<uint64_t> toggles;
+    uint64_t active_bits = 0;
+    for (int nibble = 0; nibble < 16; ++nibble) {
+        if ((active >> nibble) & 1) {
+            for (int bit = 0; bit < 4; ++bit) {
+                toggles.push_back(1ULL << (4 * nibble + bit));
+            }
+            active_bits |= 0xFULL << (4 * nibble);
+        }
+    }
+    const int set_bits = static_cast<int>(toggles.size());
+    toggles.push_back(0);
+    const uint64_t set_size = 1ULL << set_bits;
+
+    std::unique_ptr<Rng> root;
+    try {
+        root = Rng::create(rng_name, seed);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    const unsigned num_threads = defaultThreadCount();
+    const int num_round_counts = last_rounds - first_rounds + 1;
+
+    std::cout << "Starting integral experiment on " << first_rounds;
+    if (last_rounds > first_rounds) {
+        std::cout << " to " << last_rounds;
+    }
+    std::cout << "-round PRESENT..." << std::endl;
+    std::cout << "Parameters:" << std::endl;
+    std::cout << "  Number of Keys: " << num_keys << std::endl;
+    std::cout << "  Sets per Key: " << num_sets << std::endl;
+    std::cout << "  Active Nibbles: 0x" << std::hex << std::setw(4) << std::setfill('0') << active
+              << " (plaintext bits 0x" << std::setw(16) << active_bits << std::dec << ")" << std::endl;
+    std::cout << "  Plaintexts per Set: 2^" << set_bits << std::endl;
+    std::cout << "  Seed: 0x" << std::hex << std::setw(16) << std::setfill('0') << seed << std::dec << std::endl;
+    std::cout << "  Generator: " << rng_name << std::endl;
+    std::cout << "  Threads: " << num_threads << std::endl;
+    std::cout << "--------------------------------------------------" << std::endl;
+
+    // Keys and set constants are shared by every round count
+    const size_t key_length_bytes = static_cast<size_t>(Present::KeySize::KEY_80) / 8;
+    std::vector<std::vector<uint8_t>> keys(num_keys, std::vector<uint8_t>(key_length_bytes));
+    std::vector<uint64_t> constants(static_cast<size_t>(num_keys) * num_sets);
+    for (int k = 0; k < num_keys; ++k) {
+        std::unique_ptr<Rng> key_stream = root->split(k);
+        key_stream->split(0)->fillBytes(keys[k].data(), keys[k].size());
+        std::unique_ptr<Rng> set_stream = key_stream->split(1);
+        for (int s = 0; s < num_sets; ++s) {
+            constants[static_cast<size_t>(k) * num_sets + s] = set_stream->next() & ~active_bits;
+        }
+    }
+
+    // One task per (round count, key, set, chunk of the set)
+    const uint64_t chunks_per_set = (set_size + CHUNK_PLAINTEXTS - 1) / CHUNK_PLAINTEXTS;
+    const size_t num_sums = static_cast<size_t>(num_round_counts) * num_keys * num_sets;
+    std::vector<WorkerState> workers(num_threads, WorkerState(first_rounds, last_rounds, num_sums));
+
+    auto start = std::chrono::steady_clock::now();
+    parallelFor(num_sums * chunks_per_set, num_threads, [&](size_t task, unsigned w) {
+        const size_t sum = task / chunks_per_set;
+        const uint64_t chunk = task % chunks_per_set;
+        const int r = static_cast<int>(sum / (static_cast<size_t>(num_keys) * num_sets));
+        const size_t set = sum % (static_cast<size_t>(num_keys) * num_sets);
+        const int k = static_cast<int>(set / num_sets);
+        WorkerState& state = workers[w];
+
+        if (state.currentKey[r] != k) {
+            state.ciphers[r].setKey(keys[k].data(), keys[k].size());
+            state.currentKey[r] = k;
+        }
+        const uint64_t begin = chunk * CHUNK_PLAINTEXTS;
+        const uint64_t end = std::min(begin + CHUNK_PLAINTEXTS, set_size);
+        state.sums[sum] ^= xorSumPart(state.ciphers[r], constants[set], toggles, begin, end, state.buffer);
+    });
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::vector<uint64_t> sums(num_sums, 0);
+    for (const auto& state : workers) {
+        for (size_t i = 0; i < num_sums; ++i) {
+            sums[i] ^= state.sums[i];
+        }
+    }
+
+    std::cout << "Experiment Results:" << std::endl;
+    const size_t sets_per_round = static_cast<size_t>(num_keys) * num_sets;
+    for (int r = 0; r < num_round_counts; ++r) {
+        uint64_t balanced = ~0ULL; // Bits whose sum is zero in every set
+        size_t zero_sum_sets = 0;
+        std::vector<size_t> zeros(64, 0);
+        for (size_t i = 0; i < sets_per_round; ++i) {
+            const uint64_t s = sums[r * sets_per_round + i];
+            balanced &= ~s;
+            zero_sum_sets += s == 0;
+            for (int b = 0; b < 64; ++b) {
+                zeros[b] += ((s >> b) & 1) == 0;
+            }
+        }
+        const auto least = std::min_element(zeros.begin(), zeros.end());
+
+        std::cout << "Rounds " << first_rounds + r << ":" << std::endl;
+        std::cout << "  Balanced bits: " << __builtin_popcountll(balanced) << " of 64, mask 0x" << std::hex
+                  << std::setw(16) << std::setfill('0') << balanced << std::dec << std::endl;
+        std::cout << "  Pattern (nibble 15 .. 0): " << balancePattern(balanced) << std::endl;
+        std::cout << "  Zero-sum sets (all 64 bits): " << zero_sum_sets << " of " << sets_per_round << std::endl;
+        std::cout << "  Least balanced bit: " << least - zeros.begin() << ", zero in " << *least << " of "
+                  << sets_per_round << " sets" << std::endl;
+    }
+    std::cout << "A random bit passes all " << sets_per_round << " sets of a round count with probability 2^-"
+              << sets_per_round << "." << std::endl;
+
+    const double plaintexts = static_cast<double>(num_sums) * static_cast<double>(set_size);
+    std::cout << "Encrypted 2^" << std::fixed << std::setprecision(2) << std::log2(plaintexts) << " plaintexts in "
+              << elapsed.count() << " s (" << plaintexts / std::max(elapsed.count(), 1e-9) / 1e6
+              << " M plaintexts/s)" << std::defaultfloat << std::endl;
+    std::cout << "--------------------------------------------------" << std::endl;
+    std::cout << "Experiment finished." << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,287 @@
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <cmath>    // For log2, sqrt
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <memory>
+
+#include "present.hh"
+#include "present_core.hh"
+#include "present_rng.hh"
+#include "sbox_tables.hh"
+#include "difference_map.hh"
+#include "nibble_activity.hh"
+#include "thread_pool.hh"
+#include "probability_format.hh"
+
+// Linear counterpart of differential_experiment: the correlation of the
+// approximation parity(p & inMask) == parity(E(p) & outMask) is measured
+// over N plaintexts for each of --keys keys and compared with the
+// theoretical value from the S-box linear approximation table.
+//
+// The theoretical value is the expected squared correlation over the keys
+// (the linear hull): squared correlations (LAT[u][v] / 8)^2 are propagated
+// round by round as a sparse vector over masks, the pLayer moving mask bits
+// like state bits. Masks with more than MAX_ACTIVE active nibbles or a
+// squared correlation below 2^-THRESHOLD are dropped. The sign of the
+// correlation depends on the key, so the measurement is compared as the mean
+// squared correlation and its square root.
+
+// Constants
+const int DEFAULT_NUM_KEYS = 100;
+const uint64_t DEFAULT_IN_MASK = 0x0000000000200000ULL;  // Bit 21: fixed point of the pLayer, S-box 5
+const uint64_t DEFAULT_OUT_MASK = DEFAULT_IN_MASK;       // One-bit iterative approximation
+const uint64_t DEFAULT_SEED = 0x50524553454E5421ULL;
+const long long CHUNK_PLAINTEXTS = 1LL << 20; // Plaintexts per parallel task
+const int MAX_ACTIVE = 3;                     // Limits of the theoretical propagation
+const int THRESHOLD = 40;
+
+// Per-thread state: a private cipher instance and private counters
+struct WorkerState {
+    WorkerState(int rounds, int numKeys)
+        : cipher(Present::KeySize::KEY_80, rounds), currentKey(-1), counters(numKeys, 0) {}
+
+    Present cipher;
+    int currentKey;                  // Key index currently loaded into cipher
+    std::vector<long long> counters; // Plaintexts satisfying the approximation, per key
+};
+
+inline double squaredCorrelation(uint64_t u, uint64_t v) {
+    const double c = LAT.entry[u][v] / 8.0;
+    return c * c;
+}
+
+// Expand the S-boxes in pending of input mask u into every output mask
+void expandMask(uint64_t u, uint64_t pending, uint64_t v, double weight, DifferenceMap& next, double& dropped) {
+    if (pending == 0) {
+        const uint64_t out = present_detail::pLayerShift(v);
+        if (weight < std::ldexp(1.0, -THRESHOLD) || __builtin_popcountll(activeMask(out)) > MAX_ACTIVE) {
+            dropped += weight;
+        } else {
+            next.add(out, weight);
+        }
+        return;
+    }
+    const int bit = __builtin_ctzll(pending);
+    pending &= pending - 1;
+    const uint64_t in = (u >> bit) & 0xF;
+    for (uint64_t out = 1; out < 16; ++out) {
+        const double c2 = squaredCorrelation(in, out);
+        if (c2 > 0.0) {
+            expandMask(u, pending, v | (out << bit), weight * c2, next, dropped);
+        }
+    }
+}
+
+// Expected squared correlation of (inMask -> outMask) over rounds rounds
+double expectedSquaredCorrelation(uint64_t inMask, uint64_t outMask, int rounds, double& dropped) {
+    DifferenceMap current;
+    current.add(inMask, 1.0);
+    dropped = 0.0;
+    for (int round = 1; round < rounds; ++round) {
+        DifferenceMap next;
+        current.forEach(0, current.slotCount(), [&](uint64_t u, double weight) {
+            expandMask(u, activeMask(u), 0, weight, next, dropped);
+        });
+        std::swap(current, next);
+    }
+
+    // Last round: the S-box output mask must be invP(outMask)
+    const uint64_t v = present_detail::invPLayerShift(outMask);
+    double total = 0.0;
+    current.forEach(0, current.slotCount(), [&](uint64_t u, double weight) {
+        if (activeMask(u) != activeMask(v)) {
+            return;
+        }
+        for (uint64_t pending = activeMask(u); pending != 0; pending &= pending - 1) {
+            const int bit = __builtin_ctzll(pending);
+            weight *= squaredCorrelation((u >> bit) & 0xF, (v >> bit) & 0xF);
+        }
+        total += weight;
+    });
+    return total;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--in-mask <mask>] [--out-mask <mask>] [--rounds <r>]"
+              << " [--plaintexts <n>] [--keys <k>] [--threads <n>] [--seed <value>]"
+              << " [--rng splitmix|philox|present-ctr] [--lat]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+
+    uint64_t in_mask = DEFAULT_IN_MASK;
+    uint64_t out_mask = DEFAULT_OUT_MASK;
+    int rounds = 4;
+    long long n_plaintexts = 1LL << 22;
+    int num_keys = DEFAULT_NUM_KEYS;
+    unsigned num_threads = defaultThreadCount();
+    uint64_t seed = DEFAULT_SEED;
+    std::string rng_name = "splitmix";
+    bool print_lat = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--lat") {
+            print_lat = true;
+        } else if (arg == "--rng" && i + 1 < argc) {
+            rng_name = argv[++i];
+        } else if ((arg == "--in-mask" || arg == "--out-mask" || arg == "--rounds" || arg == "--plaintexts" ||
+                    arg == "--keys" || arg == "--threads" || arg == "--seed") && i + 1 < argc) {
+            std::string value = argv[++i];
+            unsigned long long number = 0;
+            try {
+                number = std::stoull(value, nullptr, 0);
+            } catch (const std::exception&) {
+                std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+                return 1;
+            }
+            if (arg == "--in-mask") {
+                in_mask = number;
+            } else if (arg == "--out-mask") {
+                out_mask = number;
+            } else if (arg == "--rounds") {
+                rounds = static_cast<int>(std::min(std::max(number, 1ULL), 31ULL));
+            } else if (arg == "--plaintexts") {
+                n_plaintexts = static_cast<long long>(std::max(number, 1ULL));
+            } else if (arg == "--keys") {
+                num_keys = static_cast<int>(std::min(std::max(number, 1ULL), 1000000ULL));
+            } else if (arg == "--threads") {
+                num_threads = number == 0 ? defaultThreadCount() : static_cast<unsigned>(number);
+            } else {
+                seed = number;
+            }
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (in_mask == 0 || out_mask == 0) {
+        std::cerr << "The masks must be non-zero." << std::endl;
+        return 1;
+    }
+
+    // Key k draws from sub-stream k of the root generator: its key from
+    // sub-stream 0 and its plaintexts from sub-stream 1 of that
+    std::unique_ptr<Rng> root;
+    try {
+        root = Rng::create(rng_name, seed);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    const long long chunks_per_key = (n_plaintexts + CHUNK_PLAINTEXTS - 1) / CHUNK_PLAINTEXTS;
+
+    std::cout << "Starting linear cryptanalysis experiment on " << rounds << "-round PRESENT..." << std::endl;
+    std::cout << "Parameters:" << std::endl;
+    std::cout << "  Number of Keys (NUM_KEYS): " << num_keys << std::endl;
+    std::cout << "  Number of Plaintexts per Key (N): " << n_plaintexts << std::endl;
+    std::cout << "  Cipher Rounds: " << rounds << std::endl;
+    std::cout << "  Input Mask:  0x" << std::hex << std::setw(16) << std::setfill('0') << in_mask << std::dec << std::endl;
+    std::cout << "  Output Mask: 0x" << std::hex << std::setw(16) << std::setfill('0') << out_mask << std::dec << std::endl;
+    std::cout << "  Seed: 0x" << std::hex << std::setw(16) << std::setfill('0') << seed << std::dec << std::endl;
+    std::cout << "  Generator: " << rng_name << std::endl;
+    std::cout << "  Threads: " << num_threads << std::endl;
+    std::cout << "--------------------------------------------------" << std::endl;
+
+    if (print_lat) {
+        std::cout << "Linear approximation table of the PRESENT S-box (rows: input mask, columns: output mask):" << std::endl;
+        for (int a = 0; a < 16; ++a) {
+            std::cout << "  " << std::hex << std::uppercase << a << std::nouppercase << std::dec << ":";
+            for (int b = 0; b < 16; ++b) {
+                std::cout << std::setw(3) << std::setfill(' ') << LAT.entry[a][b];
+            }
+            std::cout << std::endl;
+        }
+        std::cout << "--------------------------------------------------" << std::endl;
+    }
+
+    const size_t key_length_bytes = static_cast<size_t>(Present::KeySize::KEY_80) / 8;
+    std::vector<std::vector<uint8_t>> keys(num_keys);
+    std::vector<std::unique_ptr<Rng>> key_streams(num_keys);
+    for (int k = 0; k < num_keys; ++k) {
+        key_streams[k] = root->split(k);
+        keys[k].resize(key_length_bytes);
+        key_streams[k]->split(0)->fillBytes(keys[k].data(), keys[k].size());
+    }
+
+    std::vector<WorkerState> workers(num_threads, WorkerState(rounds, num_keys));
+    std::vector<std::atomic<long long>> chunks_done(num_keys);
+    for (auto& c : chunks_done) {
+        c = 0;
+    }
+    std::mutex output_mutex;
+
+    // One task per (key, chunk of plaintexts). Counters are only summed at the end.
+    parallelFor(static_cast<size_t>(num_keys) * chunks_per_key, num_threads, [&](size_t task, unsigned w) {
+        const int k = static_cast<int>(task / chunks_per_key);
+        const long long chunk = static_cast<long long>(task % chunks_per_key);
+        WorkerState& state = workers[w];
+
+        if (state.currentKey != k) {
+            state.cipher.setKey(keys[k].data(), keys[k].size());
+            state.currentKey = k;
+        }
+
+        const long long begin = chunk * CHUNK_PLAINTEXTS;
+        const long long end = std::min(begin + CHUNK_PLAINTEXTS, n_plaintexts);
+        std::unique_ptr<Rng> gen = key_streams[k]->split(1);
+        gen->discard(static_cast<uint64_t>(begin));
+        state.counters[k] += static_cast<long long>(
+            state.cipher.countLinear(in_mask, out_mask, static_cast<uint64_t>(end - begin), *gen));
+
+        if (chunks_done[k].fetch_add(1) + 1 == chunks_per_key) {
+            long long key_total = 0;
+            for (const auto& other : workers) {
+                key_total += other.counters[k];
+            }
+            const double correlation = 2.0 * key_total / n_plaintexts - 1.0;
+            std::lock_guard<std::mutex> guard(output_mutex);
+            std::cout << "  Key " << std::setw(3) << std::setfill(' ') << k + 1 << " finished. Counter T[" << k
+                      << "] = " << key_total << ", correlation " << std::showpos << std::scientific
+                      << std::setprecision(3) << correlation << std::noshowpos << std::defaultfloat << std::endl;
+        }
+    });
+
+    std::vector<long long> counters(num_keys, 0);
+    for (const auto& state : workers) {
+        for (int k = 0; k < num_keys; ++k) {
+            counters[k] += state.counters[k];
+        }
+    }
+
+    double sum_squares = 0.0;
+    double sum_abs = 0.0;
+    for (int k = 0; k < num_keys; ++k) {
+        const double correlation = 2.0 * counters[k] / n_plaintexts - 1.0;
+        sum_squares += correlation * correlation;
+        sum_abs += std::fabs(correlation);
+    }
+    // A random approximation shows a squared correlation of 1/N on average
+    const double mean_square = sum_squares / num_keys;
+    const double signal = std::max(0.0, mean_square - 1.0 / n_plaintexts);
+
+    double dropped = 0.0;
+    const double expected = expectedSquaredCorrelation(in_mask, out_mask, rounds, dropped);
+
+    std::cout << "--------------------------------------------------" << std::endl;
+    std::cout << "Experiment Results:" << std::endl;
+    std::cout << "Theoretical expected squared correlation (linear hull): " << log2String(expected)
+              << " (mass dropped by the limits: " << log2String(dropped) << ")" << std::endl;
+    std::cout << "Theoretical bias (sqrt(ELP) / 2): " << log2String(std::sqrt(expected) / 2) << std::endl;
+    std::cout << "Experimental mean squared correlation: " << log2String(mean_square)
+              << ", minus the 1/N noise: " << log2String(signal) << std::endl;
+    std::cout << "Experimental bias (sqrt(signal) / 2): " << log2String(std::sqrt(signal) / 2)
+              << ", mean |bias| " << log2String(sum_abs / num_keys / 2) << std::endl;
+    std::cout << "--------------------------------------------------" << std::endl;
+    std::cout << "Experiment finished." << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,191 @@
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+
+#include "result_file.hh"
+#include "binomial_interval.hh"
+#include "probability_format.hh"
+#include "hex_format.hh"
+
+// Combines the result files of the shards of one differential_experiment run
+// and prints the final counters table in the layout of
+// differential_cryptanalysis_results.md.
+//
+// Every file must come from the same experiment (rounds, alpha, beta, seed,
+// generator, N and number of keys) and the key ranges must not overlap.
+// Missing keys and keys still short of N plaintexts are listed; --output
+// writes the merged counters as one result file covering every key, which
+// differential_experiment --output resumes to fill in the missing work.
+
+const int TABLE_COLUMNS = 5; // (Key, Count) column pairs of the counters table
+
+// 33554432 -> "33,554,432"
+std::string withCommas(uint64_t value) {
+    std::string digits = std::to_string(value);
+    for (int i = static_cast<int>(digits.size()) - 3; i > 0; i -= 3) {
+        digits.insert(static_cast<size_t>(i), ",");
+    }
+    return digits;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--output <file>] <result file>..." << std::endl;
+    std::cerr << "  Prints the merged counters as Markdown; --output also writes them as one result file." << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+
+    std::string output_path;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--output" && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (!arg.empty() && arg[0] != '-') {
+            inputs.push_back(arg);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (inputs.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    ExperimentResult merged;
+    std::vector<int> owner; // Index of the input file holding each key, -1 if none
+    for (size_t f = 0; f < inputs.size(); ++f) {
+        ExperimentResult shard;
+        try {
+            shard = readResultFile(inputs[f]);
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        if (f == 0) {
+            merged = shard;
+            merged.firstKey = 0;
+            merged.done.assign(shard.totalKeys, 0);
+            merged.hits.assign(shard.totalKeys, 0);
+            owner.assign(shard.totalKeys, -1);
+        } else if (!shard.sameExperiment(merged)) {
+            std::cerr << inputs[f] << " comes from a different experiment than " << inputs[0] << std::endl;
+            return 1;
+        }
+        for (size_t i = 0; i < shard.done.size(); ++i) {
+            const size_t k = shard.firstKey + i;
+            if (owner[k] >= 0) {
+                std::cerr << "Key " << k << " is in both " << inputs[owner[k]] << " and " << inputs[f] << std::endl;
+                return 1;
+            }
+            owner[k] = static_cast<int>(f);
+            merged.done[k] = shard.done[i];
+            merged.hits[k] = shard.hits[i];
+        }
+    }
+
+    if (!output_path.empty()) {
+        try {
+            writeResultFile(output_path, merged);
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    const size_t num_keys = merged.totalKeys;
+    uint64_t total_trials = 0;
+    uint64_t total_successes = 0;
+    std::vector<size_t> missing;
+    std::vector<size_t> incomplete;
+    for (size_t k = 0; k < num_keys; ++k) {
+        total_trials += merged.done[k];
+        total_successes += merged.hits[k];
+        if (owner[k] < 0) {
+            missing.push_back(k);
+        } else if (merged.done[k] < merged.plaintextsPerKey) {
+            incomplete.push_back(k);
+        }
+    }
+
+    std::cout << "# Differential Cryptanalysis Experiment: " << merged.rounds << "-Round PRESENT" << std::endl;
+    std::cout << std::endl;
+    std::cout << "## Experiment Parameters" << std::endl;
+    std::cout << "- **Number of Keys (NUM_KEYS)**: " << num_keys << std::endl;
+    std::cout << "- **Number of Plaintexts per Key (N)**: " << withCommas(merged.plaintextsPerKey) << std::endl;
+    std::cout << "- **Cipher Rounds**: " << merged.rounds << std::endl;
+    std::cout << "- **Alpha (Input Difference)**: " << hex64(merged.alpha) << std::endl;
+    std::cout << "- **Beta (Output Difference)**: " << hex64(merged.beta) << std::endl;
+    std::cout << "- **Seed**: " << hex64(merged.seed) << std::endl;
+    std::cout << "- **Generator**: " << merged.rng << std::endl;
+    std::cout << "- **Result files**: " << inputs.size() << std::endl;
+    std::cout << std::endl;
+    std::cout << "---" << std::endl;
+    std::cout << std::endl;
+    std::cout << "## Experiment Results" << std::endl;
+    std::cout << std::endl;
+    std::cout << "| Parameter | Value |" << std::endl;
+    std::cout << "|-----------|-------|" << std::endl;
+    std::cout << "| Plaintexts per key | " << withCommas(merged.plaintextsPerKey) << " |" << std::endl;
+    std::cout << "| Total trials | " << withCommas(total_trials) << " |" << std::endl;
+    std::cout << "| Total successes | " << withCommas(total_successes) << " |" << std::endl;
+    if (total_trials > 0) {
+        const BinomialInterval ci = wilsonInterval(total_successes, total_trials);
+        std::cout << "| Experimental Probability (P_exp) | " << std::scientific << std::setprecision(6)
+                  << ci.estimate << std::defaultfloat << " |" << std::endl;
+        std::cout << "| P_exp expressed as | " << log2String(ci.estimate) << " |" << std::endl;
+        std::cout << "| 95% confidence interval (Wilson) | [" << log2String(ci.low) << ", "
+                  << log2String(ci.high) << "] |" << std::endl;
+    }
+    if (!missing.empty() || !incomplete.empty()) {
+        std::cout << "| Keys missing / incomplete | " << missing.size() << " / " << incomplete.size() << " |"
+                  << std::endl;
+    }
+    std::cout << std::endl;
+
+    // Keys run down the columns, as in the hand-written table
+    std::cout << "### Counters C_i for each of the " << num_keys << " keys:" << std::endl;
+    std::cout << std::endl;
+    std::cout << "|";
+    for (int c = 0; c < TABLE_COLUMNS; ++c) {
+        std::cout << " Key | Count |";
+    }
+    std::cout << std::endl << "|";
+    for (int c = 0; c < TABLE_COLUMNS; ++c) {
+        std::cout << "-----|-------|";
+    }
+    std::cout << std::endl;
+    const size_t rows = (num_keys + TABLE_COLUMNS - 1) / TABLE_COLUMNS;
+    for (size_t row = 0; row < rows; ++row) {
+        std::cout << "|";
+        for (int c = 0; c < TABLE_COLUMNS; ++c) {
+            const size_t k = row + c * rows;
+            if (k >= num_keys) {
+                std::cout << "     |       |";
+                continue;
+            }
+            // Missing keys show "-", keys short of N plaintexts a "*"
+            std::string count = owner[k] < 0 ? "-" : std::to_string(merged.hits[k]);
+            if (owner[k] >= 0 && merged.done[k] < merged.plaintextsPerKey) {
+                count += "*";
+            }
+            std::cout << " " << std::left << std::setw(3) << k << " | " << std::setw(5) << count << " |"
+                      << std::right;
+        }
+        std::cout << std::endl;
+    }
+
+    if (!missing.empty() || !incomplete.empty()) {
+        std::cout << std::endl;
+        std::cout << "`-`: key not in any result file. `*`: fewer than N plaintexts counted so far." << std::endl;
+        std::cerr << missing.size() << " key(s) missing and " << incomplete.size()
+                  << " key(s) incomplete; the totals cover the plaintexts counted so far." << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,42 @@
+/*
+ * File: nibble_activity.hh
+ *
+ * Description:    Active nibbles of 64-bit differences and masks
+ *
+ * A nibble of a difference (or of a linear mask) is active when it is
+ * non-zero, i.e. when its S-box takes part in the propagation. The trail
+ * searches walk the active nibbles, and the experiments and propagation tools
+ * use their number to bound or summarise what they record.
+ *
+ * Copyright (c) 2025 Ahmet Çobanoğlu
+ * All rights reserved.
+ *
+ * This file is proprietary and confidential. Unauthorized copying, distribution,
+ * modification, or use of this file, via any medium, is strictly prohibited
+ * without express written permission from the copyright holder.
+ */
+
+#ifndef A402B668_9568_4237_A904_AAAD6C928396
+#define A402B668_9568_4237_A904_AAAD6C928396
+
+#include <cstdint>
+
+/**
+ * @brief Indicator bit (lowest bit of the nibble) for every non-zero nibble
+ */
+inline uint64_t activeMask(uint64_t diff)
+{
+    uint64_t t = diff | (diff >> 1);
+    t |= t >> 2;
+    return t & 0x1111111111111111ULL;
+}
+
+/**
+ * @brief Number of non-zero nibbles of a 64-bit difference
+ */
+inline int activeNibbles(uint64_t diff)
+{
+    return __builtin_popcountll(activeMask(diff));
+}
+
+#endif /* A402B668_9568_4237_A904_AAAD6C928396 */
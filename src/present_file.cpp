@@ -0,0 +1,416 @@
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "present.hh"
+#include "present_modes.hh"
+#include "thread_pool.hh"
+#include "hex_format.hh"
+
+// File encryption with PRESENT in ECB, CBC or CTR mode.
+//
+// Output layout: CBC and CTR output starts with the 8-byte IV (big-endian),
+// ECB output does not. ECB and CBC plaintexts are padded with PKCS#7 to a
+// whole number of blocks; CTR output has the length of its input.
+//
+// Regular files are memory-mapped on both sides and processed directly
+// between the mappings, in CHUNK_BYTES pieces spread over the worker threads (CBC
+// encryption is serial by construction and runs on one thread). Standard
+// input/output are streamed in chunks of the same size instead.
+
+const size_t CHUNK_BYTES = 1 << 22; // Bytes per parallel task and per streamed read, a multiple of the block size
+const size_t BLOCK = present_modes::BLOCK_BYTES;
+
+enum class Mode { Ecb, Cbc, Ctr };
+
+struct Options {
+    bool decrypt = false;
+    Mode mode = Mode::Ctr;
+    std::vector<uint8_t> key;
+    bool haveIv = false;
+    uint64_t iv = 0;
+    unsigned threads = 0; // 0: one per core
+    std::string input = "-";
+    std::string output = "-";
+};
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " encrypt|decrypt --key <hex> [--mode ecb|cbc|ctr]"
+              << " [--iv <hex>] [--threads <n>] [-i <input>] [-o <output>]" << std::endl;
+    std::cerr << "  --key takes 20 (PRESENT-80) or 32 (PRESENT-128) hex digits; the default mode is ctr." << std::endl;
+    std::cerr << "  --iv is only used when encrypting (random if omitted); '-' means standard input/output." << std::endl;
+}
+
+// Read up to n bytes, retrying short reads; returns the number read (less only at end of input)
+size_t readFull(int fd, uint8_t* buf, size_t n) {
+    size_t done = 0;
+    while (done < n) {
+        ssize_t r = ::read(fd, buf + done, n - done);
+        if (r < 0) {
+            throw std::runtime_error(std::string("read failed: ") + std::strerror(errno));
+        }
+        if (r == 0) {
+            break;
+        }
+        done += static_cast<size_t>(r);
+    }
+    return done;
+}
+
+void writeFull(int fd, const uint8_t* buf, size_t n) {
+    size_t done = 0;
+    while (done < n) {
+        ssize_t w = ::write(fd, buf + done, n - done);
+        if (w < 0) {
+            throw std::runtime_error(std::string("write failed: ") + std::strerror(errno));
+        }
+        done += static_cast<size_t>(w);
+    }
+}
+
+// Number of PKCS#7 padding bytes of a decrypted final block, validated
+size_t paddingLength(const uint8_t* lastBlock) {
+    const size_t pad = lastBlock[BLOCK - 1];
+    if (pad == 0 || pad > BLOCK) {
+        throw std::runtime_error("Invalid padding (wrong key or corrupted input).");
+    }
+    for (size_t i = BLOCK - pad; i < BLOCK; ++i) {
+        if (lastBlock[i] != pad) {
+            throw std::runtime_error("Invalid padding (wrong key or corrupted input).");
+        }
+    }
+    return pad;
+}
+
+// Process len bytes of body (ciphertext or plaintext, without IV) that start at
+// byte offset pos of the stream. For ECB/CBC len is a multiple of the block size;
+// chain is the CBC chaining value before the first block and is updated.
+void processRange(const Present& cipher, const Options& opt, uint64_t pos, uint64_t& chain,
+                  const uint8_t* in, uint8_t* out, size_t len) {
+    switch (opt.mode) {
+    case Mode::Ctr:
+        present_modes::ctrCrypt(cipher, opt.iv, pos, in, out, len);
+        break;
+    case Mode::Ecb:
+        if (opt.decrypt) {
+            present_modes::ecbDecrypt(cipher, in, out, len / BLOCK);
+        } else {
+            present_modes::ecbEncrypt(cipher, in, out, len / BLOCK);
+        }
+        break;
+    case Mode::Cbc:
+        if (opt.decrypt) {
+            chain = present_modes::cbcDecrypt(cipher, chain, in, out, len / BLOCK);
+        } else {
+            chain = present_modes::cbcEncrypt(cipher, chain, in, out, len / BLOCK);
+        }
+        break;
+    }
+}
+
+// Both sides are regular files: map them and process the chunks in parallel.
+// Returns the number of plaintext bytes.
+uint64_t processMapped(const Present& cipher, Options& opt, int inFd, uint64_t inSize, int outFd) {
+    const bool padded = opt.mode != Mode::Ctr;
+    const bool hasIv = opt.mode != Mode::Ecb;
+    const size_t header = hasIv ? BLOCK : 0;
+
+    const uint8_t* inMap = nullptr;
+    if (inSize > 0) {
+        void* p = mmap(nullptr, inSize, PROT_READ, MAP_PRIVATE, inFd, 0);
+        if (p == MAP_FAILED) {
+            throw std::runtime_error(std::string("mmap of input failed: ") + std::strerror(errno));
+        }
+        madvise(p, inSize, MADV_SEQUENTIAL);
+        inMap = static_cast<const uint8_t*>(p);
+    }
+
+    const uint8_t* body = inMap;
+    uint64_t bodySize = inSize;
+    uint64_t outSize = 0;
+    if (opt.decrypt) {
+        if (inSize < header || (padded && (inSize - header == 0 || (inSize - header) % BLOCK != 0))) {
+            throw std::runtime_error("Input is not a valid ciphertext for this mode (bad length).");
+        }
+        if (hasIv) {
+            opt.iv = present_modes::loadBlock(inMap);
+        }
+        body += header;
+        bodySize -= header;
+        outSize = bodySize; // Padding is cut off once the last block is decrypted
+    } else {
+        outSize = header + (padded ? (bodySize / BLOCK + 1) * BLOCK : bodySize);
+    }
+
+    if (ftruncate(outFd, static_cast<off_t>(outSize)) != 0) {
+        throw std::runtime_error(std::string("Cannot size output: ") + std::strerror(errno));
+    }
+    uint8_t* outMap = nullptr;
+    if (outSize > 0) {
+        void* p = mmap(nullptr, outSize, PROT_READ | PROT_WRITE, MAP_SHARED, outFd, 0);
+        if (p == MAP_FAILED) {
+            throw std::runtime_error(std::string("mmap of output failed: ") + std::strerror(errno));
+        }
+        outMap = static_cast<uint8_t*>(p);
+    }
+
+    uint8_t* outBody = outMap;
+    if (!opt.decrypt && hasIv) {
+        present_modes::storeBlock(opt.iv, outMap);
+        outBody += header;
+    }
+
+    // Encryption: the mapped input holds no padding, so the whole blocks are
+    // processed from the mapping and the padded final block separately
+    const uint64_t direct = (!opt.decrypt && padded) ? bodySize / BLOCK * BLOCK : bodySize;
+    const size_t numChunks = static_cast<size_t>((direct + CHUNK_BYTES - 1) / CHUNK_BYTES);
+    uint64_t chain = opt.iv;
+
+    if (opt.mode == Mode::Cbc && !opt.decrypt) {
+        processRange(cipher, opt, 0, chain, body, outBody, static_cast<size_t>(direct));
+    } else {
+        // CTR seeks to the chunk's offset; a CBC chunk decrypts with the
+        // preceding ciphertext block as its chaining value
+        parallelFor(numChunks, opt.threads, [&](size_t task, unsigned) {
+            const uint64_t pos = static_cast<uint64_t>(task) * CHUNK_BYTES;
+            const size_t len = static_cast<size_t>(std::min<uint64_t>(CHUNK_BYTES, direct - pos));
+            uint64_t chunkChain = pos == 0 ? opt.iv : present_modes::loadBlock(body + pos - BLOCK);
+            processRange(cipher, opt, pos, chunkChain, body + pos, outBody + pos, len);
+        });
+        if (direct > 0 && opt.mode == Mode::Cbc) {
+            chain = present_modes::loadBlock(body + direct - BLOCK);
+        }
+    }
+
+    uint64_t plainSize = bodySize;
+    if (!opt.decrypt && padded) {
+        uint8_t last[BLOCK];
+        const size_t tail = static_cast<size_t>(bodySize - direct);
+        if (tail > 0) {
+            std::memcpy(last, body + direct, tail);
+        }
+        std::memset(last + tail, static_cast<int>(BLOCK - tail), BLOCK - tail);
+        processRange(cipher, opt, direct, chain, last, outBody + direct, BLOCK);
+    } else if (opt.decrypt && padded) {
+        plainSize -= paddingLength(outBody + bodySize - BLOCK);
+    }
+
+    if (outMap != nullptr) {
+        munmap(outMap, outSize);
+    }
+    if (inMap != nullptr) {
+        munmap(const_cast<uint8_t*>(inMap), inSize);
+    }
+    if (opt.decrypt && plainSize != outSize && ftruncate(outFd, static_cast<off_t>(plainSize)) != 0) {
+        throw std::runtime_error(std::string("Cannot truncate output: ") + std::strerror(errno));
+    }
+    return plainSize;
+}
+
+// Pipes and terminals: read, process and write CHUNK_BYTES at a time.
+// Returns the number of plaintext bytes.
+uint64_t processStreamed(const Present& cipher, Options& opt, int inFd, int outFd) {
+    const bool padded = opt.mode != Mode::Ctr;
+    const bool hasIv = opt.mode != Mode::Ecb;
+    std::vector<uint8_t> buf(CHUNK_BYTES + 2 * BLOCK); // Room for a held-back block and a partial one
+
+    if (hasIv) {
+        uint8_t ivBytes[BLOCK];
+        if (opt.decrypt) {
+            if (readFull(inFd, ivBytes, BLOCK) != BLOCK) {
+                throw std::runtime_error("Input is not a valid ciphertext for this mode (bad length).");
+            }
+            opt.iv = present_modes::loadBlock(ivBytes);
+        } else {
+            present_modes::storeBlock(opt.iv, ivBytes);
+            writeFull(outFd, ivBytes, BLOCK);
+        }
+    }
+
+    uint64_t pos = 0;
+    uint64_t plainSize = 0;
+    uint64_t chain = opt.iv;
+    // When decrypting a padded mode the last block read is held back until the
+    // next read shows whether it is the final one
+    size_t held = 0;
+    for (;;) {
+        const size_t got = readFull(inFd, buf.data() + held, CHUNK_BYTES);
+        size_t avail = held + got;
+        const bool atEnd = got < CHUNK_BYTES;
+
+        size_t len = avail;
+        if (padded) {
+            len = avail / BLOCK * BLOCK;
+            if (opt.decrypt && !atEnd) {
+                len = len >= BLOCK ? len - BLOCK : 0;
+            }
+        }
+        if (!atEnd || !padded || opt.decrypt) {
+            processRange(cipher, opt, pos, chain, buf.data(), buf.data(), len);
+        }
+
+        if (atEnd) {
+            if (!padded) {
+                writeFull(outFd, buf.data(), len);
+                plainSize += len;
+            } else if (opt.decrypt) {
+                if (len == 0 || avail != len) {
+                    throw std::runtime_error("Input is not a valid ciphertext for this mode (bad length).");
+                }
+                len -= paddingLength(buf.data() + len - BLOCK);
+                writeFull(outFd, buf.data(), len);
+                plainSize += len;
+            } else {
+                const size_t tail = avail - len;
+                std::memset(buf.data() + avail, static_cast<int>(BLOCK - tail), BLOCK - tail);
+                processRange(cipher, opt, pos, chain, buf.data(), buf.data(), len + BLOCK);
+                writeFull(outFd, buf.data(), len + BLOCK);
+                plainSize += avail;
+            }
+            break;
+        }
+
+        writeFull(outFd, buf.data(), len);
+        plainSize += len;
+        pos += len;
+        held = avail - len;
+        std::memmove(buf.data(), buf.data() + len, held);
+    }
+    return plainSize;
+}
+
+int main(int argc, char* argv[]) {
+
+    Options opt;
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    std::string command = argv[1];
+    if (command == "encrypt" || command == "decrypt") {
+        opt.decrypt = command == "decrypt";
+    } else {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            std::string value = argv[++i];
+            if (arg == "--mode") {
+                if (value == "ecb") {
+                    opt.mode = Mode::Ecb;
+                } else if (value == "cbc") {
+                    opt.mode = Mode::Cbc;
+                } else if (value == "ctr") {
+                    opt.mode = Mode::Ctr;
+                } else {
+                    throw std::invalid_argument("Unknown mode: " + value);
+                }
+            } else if (arg == "--key") {
+                opt.key = parseHex(value);
+            } else if (arg == "--iv") {
+                std::vector<uint8_t> iv = parseHex(value);
+                if (iv.size() != BLOCK) {
+                    throw std::invalid_argument("The IV must be 16 hex digits.");
+                }
+                opt.iv = present_modes::loadBlock(iv.data());
+                opt.haveIv = true;
+            } else if (arg == "--threads") {
+                opt.threads = static_cast<unsigned>(std::stoul(value, nullptr, 0));
+            } else if (arg == "-i") {
+                opt.input = value;
+            } else if (arg == "-o") {
+                opt.output = value;
+            } else {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    Present::KeySize key_size;
+    if (opt.key.size() == static_cast<size_t>(Present::KeySize::KEY_80) / 8) {
+        key_size = Present::KeySize::KEY_80;
+    } else if (opt.key.size() == static_cast<size_t>(Present::KeySize::KEY_128) / 8) {
+        key_size = Present::KeySize::KEY_128;
+    } else {
+        std::cerr << "The key must be 20 or 32 hex digits." << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (opt.threads == 0) {
+        opt.threads = defaultThreadCount();
+    }
+    if (!opt.decrypt && !opt.haveIv) {
+        std::random_device rd;
+        opt.iv = (static_cast<uint64_t>(rd()) << 32) | rd();
+    }
+
+    Present cipher(key_size, 31);
+    cipher.setKey(opt.key.data(), opt.key.size());
+
+    int in_fd = STDIN_FILENO;
+    int out_fd = STDOUT_FILENO;
+    try {
+        if (opt.input != "-") {
+            in_fd = ::open(opt.input.c_str(), O_RDONLY);
+            if (in_fd < 0) {
+                throw std::runtime_error("Cannot open " + opt.input + ": " + std::strerror(errno));
+            }
+        }
+        if (opt.output != "-") {
+            out_fd = ::open(opt.output.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (out_fd < 0) {
+                throw std::runtime_error("Cannot open " + opt.output + ": " + std::strerror(errno));
+            }
+        }
+
+        struct stat in_stat;
+        struct stat out_stat;
+        const bool mappable = fstat(in_fd, &in_stat) == 0 && S_ISREG(in_stat.st_mode) &&
+                              fstat(out_fd, &out_stat) == 0 && S_ISREG(out_stat.st_mode);
+
+        auto start = std::chrono::steady_clock::now();
+        uint64_t bytes = mappable
+            ? processMapped(cipher, opt, in_fd, static_cast<uint64_t>(in_stat.st_size), out_fd)
+            : processStreamed(cipher, opt, in_fd, out_fd);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cerr << (opt.decrypt ? "Decrypted " : "Encrypted ") << bytes << " bytes in "
+                  << elapsed.count() << " s (" << (elapsed.count() > 0 ? bytes / elapsed.count() / 1e6 : 0.0)
+                  << " MB/s, " << (mappable ? opt.threads : 1u) << " thread(s))" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    if (in_fd != STDIN_FILENO) {
+        ::close(in_fd);
+    }
+    if (out_fd != STDOUT_FILENO && ::close(out_fd) != 0) {
+        std::cerr << "Error: closing output failed: " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    return 0;
+}
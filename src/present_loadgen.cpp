@@ -0,0 +1,452 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "present.hh"
+#include "present_rng.hh"
+#include "present_service.hh"
+
+// Load generator for present_server.
+//
+// For every batch window in --windows, the server is reconfigured with it and
+// --connections client threads run for --seconds. Every thread keeps --depth
+// requests of --blocks blocks in flight on its own connection and records the
+// latency of each request, from just before it is sent to the arrival of its
+// response. The report gives, per window, the request and block throughput
+// and the latency percentiles over all connections. The first response of
+// every connection is checked against a local Present.
+//
+// Connection c uses key c % --keys, so --keys 1 lets the server coalesce all
+// connections into one buffer and larger values split every batch by key. For
+// comparison, the in-process rates of encrypt() on single blocks and of
+// encryptBlocks() on requests of the same size are printed first.
+
+const uint64_t DEFAULT_SEED = 0x4C4F414447454E00ULL; // "LOADGEN"
+const size_t MAX_IN_FLIGHT_BYTES = 4 << 20; // Per connection, well below what the server buffers before pushing back
+
+using Clock = std::chrono::steady_clock;
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--socket <path>] [--windows <us,us,...>] [--connections <n>]"
+              << " [--depth <n>] [--blocks <n>] [--seconds <s>] [--batch-blocks <n>] [--keys <n>]"
+              << " [--key-size 80|128] [--decrypt] [--seed <s>]" << std::endl;
+    std::cerr << "  Defaults: " << SERVICE_DEFAULT_SOCKET << ", windows 0,50,200,1000, 4 connections of depth 1,"
+              << " 8 blocks, 2 s per window, one key of 80 bits." << std::endl;
+}
+
+std::string systemError(const std::string& what) {
+    return what + ": " + std::strerror(errno);
+}
+
+int connectService(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("socket path too long: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw std::runtime_error(systemError("socket"));
+    }
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        const std::string message = systemError("connect " + path);
+        close(fd);
+        throw std::runtime_error(message);
+    }
+    return fd;
+}
+
+void sendAll(int fd, const char* data, size_t n) {
+    while (n > 0) {
+        const ssize_t w = send(fd, data, n, MSG_NOSIGNAL);
+        if (w < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(systemError("send"));
+        }
+        data += w;
+        n -= w;
+    }
+}
+
+void receiveAll(int fd, char* data, size_t n) {
+    while (n > 0) {
+        const ssize_t r = recv(fd, data, n, 0);
+        if (r < 0 && errno == EINTR) {
+            continue;
+        }
+        if (r <= 0) {
+            throw std::runtime_error(r == 0 ? "server closed the connection" : systemError("recv"));
+        }
+        data += r;
+        n -= r;
+    }
+}
+
+// Send one request and wait for its response, whose payload is stored in reply
+ServiceHeader call(int fd, const ServiceHeader& request, const void* payload, std::vector<char>* reply = nullptr) {
+    std::vector<char> message(sizeof(ServiceHeader) + servicePayloadBytes(request));
+    putServiceHeader(message.data(), request);
+    if (message.size() > sizeof(ServiceHeader)) {
+        std::memcpy(message.data() + sizeof(ServiceHeader), payload, message.size() - sizeof(ServiceHeader));
+    }
+    sendAll(fd, message.data(), message.size());
+
+    char header[sizeof(ServiceHeader)];
+    receiveAll(fd, header, sizeof(header));
+    const ServiceHeader response = getServiceHeader(header);
+    const size_t bytes = response.status == 0 && (response.op == static_cast<uint8_t>(ServiceOp::Encrypt) ||
+                                                  response.op == static_cast<uint8_t>(ServiceOp::Decrypt))
+                             ? static_cast<size_t>(response.count) * 8
+                             : 0;
+    std::vector<char> discard;
+    std::vector<char>& out = reply ? *reply : discard;
+    out.resize(bytes);
+    receiveAll(fd, out.data(), bytes);
+    return response;
+}
+
+struct ClientResult {
+    uint64_t requests = 0;
+    uint64_t blocks = 0;
+    std::vector<uint32_t> latencies; ///< Nanoseconds, saturated
+    bool verified = false;
+    std::string error;
+};
+
+struct Load {
+    std::string path;
+    unsigned connections = 4;
+    unsigned depth = 1;
+    uint32_t blocks = 8;
+    double seconds = 2.0;
+    bool decrypt = false;
+    std::vector<std::vector<uint8_t>> keys;
+    uint64_t seed = DEFAULT_SEED;
+};
+
+// One connection: set the key, then keep load.depth requests in flight until the deadline
+void runClient(const Load& load, unsigned index, std::atomic<unsigned>& ready, const std::atomic<bool>& go,
+               const Clock::time_point& deadline, ClientResult& result) {
+    int fd = -1;
+    bool counted = false;
+    try {
+        fd = connectService(load.path);
+        const std::vector<uint8_t>& key = load.keys[index % load.keys.size()];
+        ServiceHeader setKey;
+        setKey.op = static_cast<uint8_t>(ServiceOp::SetKey);
+        setKey.count = static_cast<uint32_t>(key.size());
+        const ServiceHeader keyResponse = call(fd, setKey, key.data());
+        if (keyResponse.status != 0) {
+            throw std::runtime_error("SetKey failed with status " + std::to_string(keyResponse.status));
+        }
+        Present local(key.size() == 10 ? Present::KeySize::KEY_80 : Present::KeySize::KEY_128);
+        local.setKey(key.data(), key.size());
+
+        // Every slot is a complete request message, resent unchanged
+        const size_t size = sizeof(ServiceHeader) + static_cast<size_t>(load.blocks) * 8;
+        std::vector<char> messages(size * load.depth);
+        std::vector<uint64_t> plain(static_cast<size_t>(load.blocks) * load.depth);
+        std::unique_ptr<Rng> rng = Rng::create("splitmix", load.seed)->split(index);
+        rng->fillPlaintexts(plain.data(), plain.size());
+        for (unsigned slot = 0; slot < load.depth; ++slot) {
+            ServiceHeader request;
+            request.id = slot;
+            request.op = static_cast<uint8_t>(load.decrypt ? ServiceOp::Decrypt : ServiceOp::Encrypt);
+            request.handle = keyResponse.handle;
+            request.count = load.blocks;
+            putServiceHeader(&messages[slot * size], request);
+            std::memcpy(&messages[slot * size + sizeof(ServiceHeader)], &plain[slot * load.blocks],
+                        static_cast<size_t>(load.blocks) * 8);
+        }
+        std::vector<Clock::time_point> sent(load.depth);
+        std::vector<uint64_t> reply(load.blocks);
+        std::vector<uint64_t> expected(load.blocks);
+        result.latencies.reserve(1 << 16);
+
+        ready.fetch_add(1);
+        counted = true;
+        while (!go.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+
+        for (unsigned slot = 0; slot < load.depth; ++slot) {
+            sent[slot] = Clock::now();
+            sendAll(fd, &messages[slot * size], size);
+        }
+        unsigned inFlight = load.depth;
+        while (inFlight > 0) {
+            char header[sizeof(ServiceHeader)];
+            receiveAll(fd, header, sizeof(header));
+            const ServiceHeader response = getServiceHeader(header);
+            if (response.status != 0 || response.id >= load.depth || response.count != load.blocks) {
+                throw std::runtime_error("unexpected response with status " + std::to_string(response.status));
+            }
+            receiveAll(fd, reinterpret_cast<char*>(reply.data()), reply.size() * 8);
+            const Clock::time_point now = Clock::now();
+            const uint64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(now - sent[response.id]).count();
+            result.latencies.push_back(static_cast<uint32_t>(std::min<uint64_t>(nanos, UINT32_MAX)));
+            ++result.requests;
+            result.blocks += load.blocks;
+
+            if (!result.verified) {
+                const uint64_t* in = &plain[static_cast<size_t>(response.id) * load.blocks];
+                if (load.decrypt) {
+                    local.decryptBlocks(in, expected.data(), load.blocks);
+                } else {
+                    local.encryptBlocks(in, expected.data(), load.blocks);
+                }
+                if (reply != expected) {
+                    throw std::runtime_error("response differs from the local cipher");
+                }
+                result.verified = true;
+            }
+
+            if (now < deadline) {
+                sent[response.id] = Clock::now();
+                sendAll(fd, &messages[static_cast<size_t>(response.id) * size], size);
+            } else {
+                --inFlight;
+            }
+        }
+    } catch (const std::exception& e) {
+        result.error = e.what();
+        if (!counted) {
+            ready.fetch_add(1); // Main waits for every client before starting the clock
+        }
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+double percentile(std::vector<uint32_t>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const size_t index = std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()));
+    return sorted[index] / 1000.0;
+}
+
+volatile uint64_t baselineSink; // Keeps the baseline loops from being optimised away
+
+// In-process rates for comparison
+void printBaseline(const Load& load) {
+    const std::vector<uint8_t>& key = load.keys.front();
+    Present cipher(key.size() == 10 ? Present::KeySize::KEY_80 : Present::KeySize::KEY_128);
+    cipher.setKey(key.data(), key.size());
+    std::vector<uint64_t> blocks(load.blocks);
+    Rng::create("splitmix", load.seed)->fillPlaintexts(blocks.data(), blocks.size());
+
+    uint64_t sink = 0;
+    uint64_t single = 0;
+    Clock::time_point start = Clock::now();
+    const Clock::time_point end = start + std::chrono::milliseconds(200);
+    while (Clock::now() < end) {
+        for (int i = 0; i < 1024; ++i) {
+            sink += cipher.encrypt(blocks[i % blocks.size()] ^ sink);
+        }
+        single += 1024;
+    }
+    const double singleRate = single / std::chrono::duration<double>(Clock::now() - start).count();
+
+    uint64_t batched = 0;
+    start = Clock::now();
+    const Clock::time_point batchEnd = start + std::chrono::milliseconds(200);
+    while (Clock::now() < batchEnd) {
+        for (int i = 0; i < 64; ++i) {
+            cipher.encryptBlocks(blocks.data(), blocks.data(), blocks.size());
+        }
+        batched += 64 * blocks.size();
+    }
+    baselineSink = sink + blocks[0];
+    const double batchedRate = batched / std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::cout << std::fixed << std::setprecision(2) << "In process: encrypt() " << singleRate / 1e6
+              << " M blocks/s, encryptBlocks() on " << load.blocks << " blocks " << batchedRate / 1e6
+              << " M blocks/s" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+
+    Load load;
+    load.path = SERVICE_DEFAULT_SOCKET;
+    std::vector<uint32_t> windows = {0, 50, 200, 1000};
+    uint32_t batch_blocks = 0; // Keep the server's
+    unsigned num_keys = 1;
+    int key_size = 80;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) {
+            load.path = argv[++i];
+        } else if (arg == "--decrypt") {
+            load.decrypt = true;
+        } else if (arg == "--windows" && i + 1 < argc) {
+            std::string value = argv[++i];
+            windows.clear();
+            std::stringstream list(value);
+            std::string item;
+            try {
+                while (std::getline(list, item, ',')) {
+                    const unsigned long long window = std::stoull(item, nullptr, 0);
+                    windows.push_back(static_cast<uint32_t>(std::min<unsigned long long>(window, SERVICE_MAX_WINDOW_US)));
+                }
+            } catch (const std::exception&) {
+                std::cerr << "Invalid value for --windows: " << value << std::endl;
+                return 1;
+            }
+            if (windows.empty()) {
+                std::cerr << "--windows needs at least one window." << std::endl;
+                return 1;
+            }
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            std::string value = argv[++i];
+            try {
+                load.seconds = std::stod(value);
+            } catch (const std::exception&) {
+                std::cerr << "Invalid value for --seconds: " << value << std::endl;
+                return 1;
+            }
+        } else if ((arg == "--connections" || arg == "--depth" || arg == "--blocks" || arg == "--batch-blocks" ||
+                    arg == "--keys" || arg == "--key-size" || arg == "--seed") &&
+                   i + 1 < argc) {
+            std::string value = argv[++i];
+            unsigned long long number = 0;
+            try {
+                number = std::stoull(value, nullptr, 0);
+            } catch (const std::exception&) {
+                std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+                return 1;
+            }
+            if (arg == "--connections") {
+                load.connections = static_cast<unsigned>(std::min(std::max(number, 1ULL), 4096ULL));
+            } else if (arg == "--depth") {
+                load.depth = static_cast<unsigned>(std::min(std::max(number, 1ULL), 4096ULL));
+            } else if (arg == "--blocks") {
+                load.blocks = static_cast<uint32_t>(std::min<unsigned long long>(std::max(number, 1ULL), SERVICE_MAX_BLOCKS));
+            } else if (arg == "--batch-blocks") {
+                batch_blocks = static_cast<uint32_t>(std::min<unsigned long long>(number, SERVICE_MAX_BATCH_BLOCKS));
+            } else if (arg == "--keys") {
+                num_keys = static_cast<unsigned>(std::min(std::max(number, 1ULL), 4096ULL));
+            } else if (arg == "--key-size") {
+                key_size = static_cast<int>(number);
+            } else {
+                load.seed = number;
+            }
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (key_size != 80 && key_size != 128) {
+        std::cerr << "--key-size must be 80 or 128." << std::endl;
+        return 1;
+    }
+    if (static_cast<size_t>(load.depth) * load.blocks * 8 > MAX_IN_FLIGHT_BYTES) {
+        std::cerr << "--depth x --blocks exceeds " << MAX_IN_FLIGHT_BYTES / 8 << " blocks in flight." << std::endl;
+        return 1;
+    }
+
+    std::unique_ptr<Rng> key_rng = Rng::create("splitmix", load.seed)->split(0xFFFFFFFF);
+    for (unsigned k = 0; k < num_keys; ++k) {
+        std::vector<uint8_t> key(key_size / 8);
+        key_rng->fillBytes(key.data(), key.size());
+        load.keys.push_back(key);
+    }
+
+    std::cout << load.connections << " connections x depth " << load.depth << ", " << load.blocks << " blocks ("
+              << load.blocks * 8 << " bytes) per " << (load.decrypt ? "decrypt" : "encrypt") << " request, "
+              << num_keys << " key(s) of " << key_size << " bits, " << load.seconds << " s per window" << std::endl;
+    printBaseline(load);
+
+    int control = -1;
+    try {
+        control = connectService(load.path);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << std::endl;
+    std::cout << std::setw(10) << "window_us" << std::setw(12) << "req/s" << std::setw(14) << "M blocks/s"
+              << std::setw(10) << "MB/s" << std::setw(10) << "p50_us" << std::setw(10) << "p99_us"
+              << std::setw(11) << "p99.9_us" << std::setw(10) << "max_us" << std::endl;
+
+    int status = 0;
+    for (uint32_t window : windows) {
+        ServiceHeader configure;
+        configure.op = static_cast<uint8_t>(ServiceOp::Configure);
+        configure.handle = window;
+        configure.count = batch_blocks;
+        try {
+            if (call(control, configure, nullptr).status != 0) {
+                throw std::runtime_error("the server refused window " + std::to_string(window));
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            status = 1;
+            break;
+        }
+
+        std::vector<ClientResult> results(load.connections);
+        std::atomic<unsigned> ready(0);
+        std::atomic<bool> go(false);
+        Clock::time_point deadline;
+        std::vector<std::thread> clients;
+        for (unsigned c = 0; c < load.connections; ++c) {
+            clients.emplace_back(runClient, std::cref(load), c, std::ref(ready), std::cref(go), std::cref(deadline),
+                                 std::ref(results[c]));
+        }
+        while (ready.load() < load.connections) {
+            std::this_thread::yield();
+        }
+        const Clock::time_point start = Clock::now();
+        deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(load.seconds));
+        go.store(true, std::memory_order_release);
+        for (auto& t : clients) {
+            t.join();
+        }
+        const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        uint64_t requests = 0;
+        uint64_t blocks = 0;
+        std::vector<uint32_t> latencies;
+        for (ClientResult& r : results) {
+            if (!r.error.empty()) {
+                std::cerr << "Error: " << r.error << std::endl;
+                status = 1;
+            }
+            requests += r.requests;
+            blocks += r.blocks;
+            latencies.insert(latencies.end(), r.latencies.begin(), r.latencies.end());
+        }
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << std::fixed << std::setw(10) << window << std::setprecision(0) << std::setw(12)
+                  << requests / elapsed << std::setprecision(2) << std::setw(14) << blocks / elapsed / 1e6
+                  << std::setprecision(1) << std::setw(10) << blocks * 8 / elapsed / 1e6 << std::setw(10)
+                  << percentile(latencies, 0.5) << std::setw(10) << percentile(latencies, 0.99) << std::setw(11)
+                  << percentile(latencies, 0.999) << std::setw(10) << percentile(latencies, 1.0) << std::endl;
+        if (status != 0) {
+            break;
+        }
+    }
+    close(control);
+    return status;
+}
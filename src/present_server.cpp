@@ -0,0 +1,693 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "present.hh"
+#include "present_service.hh"
+#include "thread_pool.hh"
+
+// Local encryption service that batches the small requests of many clients.
+//
+// One thread runs an epoll loop over the listening socket, the client
+// connections, a timerfd for the batch window and a signalfd for shutdown.
+// Requests are parsed as soon as they are complete. SetKey and DropKey act at
+// once on a cache of expanded schedules; the blocks of Encrypt and Decrypt
+// requests are appended to one buffer per (handle, direction). The batch is
+// processed when the window opened by its first request expires, or as soon
+// as it holds --batch-blocks blocks: every buffer goes through
+// encryptBlocks() or decryptBlocks() in one call (split over the worker
+// threads when large) and the responses are written back in request order.
+// Requests arriving meanwhile wait in the socket buffers and join the next
+// batch, and a window of 0 still coalesces everything read in one pass over
+// the ready connections.
+//
+// Responses a client does not read pile up in its output buffer; past
+// MAX_OUTPUT_BYTES the server stops reading that client's requests until it
+// catches up.
+
+const size_t READ_CHUNK = 1 << 16;
+const size_t MAX_READ_PER_WAKEUP = 1 << 20; // Per connection, so one busy client cannot starve the others
+const size_t MAX_OUTPUT_BYTES = 8 << 20;
+const size_t PARALLEL_MIN_BLOCKS = 1 << 14; // Batch buffers at least this large are split over the workers
+const uint32_t DEFAULT_WINDOW_US = 100;
+const uint32_t DEFAULT_BATCH_BLOCKS = 8192;
+const size_t DEFAULT_MAX_KEYS = 4096;
+const int MAX_EVENTS = 64;
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--socket <path>] [--window-us <us>] [--batch-blocks <n>]"
+              << " [--threads <n>] [--max-keys <n>]" << std::endl;
+    std::cerr << "  Defaults: " << SERVICE_DEFAULT_SOCKET << ", a " << DEFAULT_WINDOW_US << " us window, "
+              << DEFAULT_BATCH_BLOCKS << " blocks, one thread per core, " << DEFAULT_MAX_KEYS << " keys." << std::endl;
+}
+
+std::string systemError(const std::string& what) {
+    return what + ": " + std::strerror(errno);
+}
+
+// Expanded schedules by handle; setting a key that is already cached takes another reference to it
+class KeyCache {
+public:
+    explicit KeyCache(size_t maxKeys) : maxKeys_(maxKeys), nextHandle_(1) {}
+
+    ServiceStatus acquire(const char* key, size_t length, uint32_t& handle)
+    {
+        if (length != 10 && length != 16) {
+            return ServiceStatus::BadRequest;
+        }
+        const std::string bytes(key, length);
+        auto cached = byKey_.find(bytes);
+        if (cached != byKey_.end()) {
+            handle = cached->second;
+            ++entries_[handle].refs;
+            return ServiceStatus::Ok;
+        }
+        if (entries_.size() >= maxKeys_) {
+            return ServiceStatus::TooManyKeys;
+        }
+
+        auto cipher = std::make_shared<Present>(length == 10 ? Present::KeySize::KEY_80 : Present::KeySize::KEY_128);
+        cipher->setKey(reinterpret_cast<const uint8_t*>(key), length);
+        // Handle 0 is never issued, and a wrapped counter skips the handles still in use
+        do {
+            handle = nextHandle_++;
+        } while (handle == 0 || entries_.count(handle) != 0);
+        entries_[handle] = Entry{cipher, bytes, 1};
+        byKey_[bytes] = handle;
+        return ServiceStatus::Ok;
+    }
+
+    void release(uint32_t handle)
+    {
+        auto entry = entries_.find(handle);
+        if (entry != entries_.end() && --entry->second.refs == 0) {
+            byKey_.erase(entry->second.key);
+            entries_.erase(entry);
+        }
+    }
+
+    std::shared_ptr<const Present> find(uint32_t handle) const
+    {
+        auto entry = entries_.find(handle);
+        return entry == entries_.end() ? nullptr : entry->second.cipher;
+    }
+
+    size_t size() const { return entries_.size(); }
+
+private:
+    struct Entry {
+        std::shared_ptr<const Present> cipher; // Batches in flight keep a dropped schedule alive
+        std::string key;
+        uint64_t refs;
+    };
+
+    size_t maxKeys_;
+    uint32_t nextHandle_;
+    std::unordered_map<uint32_t, Entry> entries_;
+    std::unordered_map<std::string, uint32_t> byKey_;
+};
+
+struct Connection {
+    int fd = -1;
+    std::string in;                // Received bytes; the requests before inPos are parsed
+    size_t inPos = 0;
+    std::string out;               // Responses; the bytes before outPos are sent
+    size_t outPos = 0;
+    std::vector<uint32_t> handles; // One entry per key reference held
+    size_t queued = 0;             // Requests waiting for the batch, so later responses must wait too
+    uint32_t events = 0;           // Registered epoll events
+    bool eof = false;              // The client has shut down its side
+    bool parsing = false;          // Requests are being handled; an eof close must wait until they all are
+    bool closed = false;
+    bool touched = false;          // Has new responses in the current flush
+};
+
+class Server {
+public:
+    Server(const std::string& path, uint32_t windowUs, uint32_t batchBlocks, unsigned threads, size_t maxKeys)
+        : path_(path), window_(windowUs), batchBlocks_(batchBlocks), threads_(threads), keys_(maxKeys)
+    {
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        if (sigprocmask(SIG_BLOCK, &signals, nullptr) != 0) {
+            throw std::runtime_error(systemError("sigprocmask"));
+        }
+        signal(SIGPIPE, SIG_IGN);
+
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            throw std::runtime_error("socket path too long: " + path);
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        // A socket left by an earlier run is replaced, anything else at the path is not
+        struct stat existing;
+        if (lstat(path.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode)) {
+            unlink(path.c_str());
+        }
+
+        epoll_ = checked(epoll_create1(EPOLL_CLOEXEC), "epoll_create1");
+        listen_ = checked(socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0), "socket");
+        checked(bind(listen_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)), "bind " + path);
+        bound_ = true;
+        checked(::listen(listen_, SOMAXCONN), "listen");
+        timer_ = checked(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC), "timerfd_create");
+        signal_ = checked(signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC), "signalfd");
+        for (int fd : {listen_, timer_, signal_}) {
+            watch(fd, EPOLL_CTL_ADD, EPOLLIN);
+        }
+    }
+
+    ~Server()
+    {
+        for (auto& entry : connections_) {
+            ::close(entry.first);
+        }
+        for (int fd : {signal_, timer_, listen_, epoll_}) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+        if (bound_) {
+            unlink(path_.c_str());
+        }
+    }
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    void run()
+    {
+        epoll_event events[MAX_EVENTS];
+        bool running = true;
+        while (running) {
+            const int n = epoll_wait(epoll_, events, MAX_EVENTS, -1);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error(systemError("epoll_wait"));
+            }
+
+            bool windowExpired = false;
+            for (int i = 0; i < n; ++i) {
+                const int fd = events[i].data.fd;
+                if (fd == listen_) {
+                    acceptAll();
+                } else if (fd == signal_) {
+                    running = false;
+                } else if (fd == timer_) {
+                    uint64_t expirations;
+                    while (read(timer_, &expirations, sizeof(expirations)) > 0) {
+                    }
+                    // A stale expiration must not cut short a window opened after the last flush
+                    windowExpired = std::chrono::steady_clock::now() >= deadline_;
+                } else {
+                    auto found = connections_.find(fd);
+                    if (found == connections_.end()) {
+                        continue; // Closed earlier in this pass
+                    }
+                    std::shared_ptr<Connection> connection = found->second;
+                    if (events[i].events & EPOLLOUT) {
+                        writeTo(*connection);
+                    }
+                    if (!connection->closed && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+                        readFrom(connection);
+                    }
+                }
+            }
+
+            if (!pending_.empty() && (windowExpired || window_ == 0 || pendingBlocks_ >= batchBlocks_)) {
+                flush();
+            }
+        }
+        flush();
+    }
+
+    void printStats(std::ostream& out) const
+    {
+        out << accepted_ << " connections, " << requests_ << " requests, " << blocks_ << " blocks in " << batches_
+            << " batches";
+        if (batches_ > 0) {
+            out << std::fixed << std::setprecision(1) << " (" << static_cast<double>(batchedRequests_) / batches_ << " requests and "
+                << static_cast<double>(blocks_) / batches_ << " blocks per batch, largest " << largestBatch_ << ")";
+        }
+        out << ", " << keys_.size() << " keys cached" << std::endl;
+    }
+
+private:
+    // A request whose response waits for the batch; group < 0 for one without blocks
+    struct Pending {
+        std::shared_ptr<Connection> connection;
+        ServiceHeader response;
+        int group;
+        size_t offset;
+    };
+
+    // The blocks of one handle and direction in the current batch
+    struct Group {
+        std::shared_ptr<const Present> cipher;
+        bool decrypt = false;
+        std::vector<uint64_t> blocks;
+    };
+
+    static int checked(int result, const std::string& what)
+    {
+        if (result < 0) {
+            throw std::runtime_error(systemError(what));
+        }
+        return result;
+    }
+
+    void watch(int fd, int op, uint32_t events)
+    {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = fd;
+        checked(epoll_ctl(epoll_, op, fd, &event), "epoll_ctl");
+    }
+
+    void acceptAll()
+    {
+        for (;;) {
+            const int fd = accept4(listen_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ECONNABORTED) {
+                    std::cerr << systemError("accept4") << std::endl;
+                }
+                if (errno == EINTR || errno == ECONNABORTED) {
+                    continue;
+                }
+                return;
+            }
+            auto connection = std::make_shared<Connection>();
+            connection->fd = fd;
+            connection->events = EPOLLIN;
+            watch(fd, EPOLL_CTL_ADD, EPOLLIN);
+            connections_[fd] = connection;
+            ++accepted_;
+        }
+    }
+
+    void close(Connection& connection)
+    {
+        if (connection.closed) {
+            return;
+        }
+        connection.closed = true;
+        for (uint32_t handle : connection.handles) {
+            keys_.release(handle);
+        }
+        connection.handles.clear();
+        ::close(connection.fd); // Also removes it from the epoll set
+        connections_.erase(connection.fd);
+    }
+
+    // Register the events the connection's state calls for
+    void updateEvents(Connection& connection)
+    {
+        const size_t backlog = connection.out.size() - connection.outPos;
+        uint32_t events = 0;
+        if (!connection.eof && backlog < MAX_OUTPUT_BYTES) {
+            events |= EPOLLIN;
+        }
+        if (backlog > 0) {
+            events |= EPOLLOUT;
+        }
+        if (events != connection.events) {
+            watch(connection.fd, EPOLL_CTL_MOD, events);
+            connection.events = events;
+        }
+    }
+
+    void readFrom(const std::shared_ptr<Connection>& connection)
+    {
+        Connection& c = *connection;
+        size_t total = 0;
+        while (total < MAX_READ_PER_WAKEUP) {
+            const size_t old = c.in.size();
+            c.in.resize(old + READ_CHUNK);
+            const ssize_t r = ::read(c.fd, &c.in[old], READ_CHUNK);
+            c.in.resize(old + std::max<ssize_t>(r, 0));
+            if (r > 0) {
+                total += r;
+                if (static_cast<size_t>(r) < READ_CHUNK) {
+                    break; // Drained
+                }
+            } else if (r == 0) {
+                c.eof = true;
+                break;
+            } else if (errno == EINTR) {
+                continue;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            } else {
+                close(c);
+                return;
+            }
+        }
+
+        parse(connection);
+        if (c.closed) {
+            return;
+        }
+        if (c.eof && c.queued == 0 && c.outPos == c.out.size()) {
+            close(c);
+            return;
+        }
+        updateEvents(c);
+    }
+
+    void parse(const std::shared_ptr<Connection>& connection)
+    {
+        Connection& c = *connection;
+        c.parsing = true;
+        while (!c.closed && c.in.size() - c.inPos >= sizeof(ServiceHeader)) {
+            const ServiceHeader request = getServiceHeader(&c.in[c.inPos]);
+            const ServiceOp op = static_cast<ServiceOp>(request.op);
+            // Nothing after a request of this size can be trusted to be a header
+            if (((op == ServiceOp::Encrypt || op == ServiceOp::Decrypt) && request.count > SERVICE_MAX_BLOCKS) ||
+                (op == ServiceOp::SetKey && request.count > SERVICE_MAX_KEY_BYTES)) {
+                close(c);
+                break;
+            }
+            const size_t size = sizeof(ServiceHeader) + servicePayloadBytes(request);
+            if (c.in.size() - c.inPos < size) {
+                break;
+            }
+            handle(connection, request, &c.in[c.inPos + sizeof(ServiceHeader)]);
+            c.inPos += size;
+        }
+        c.parsing = false;
+        if (c.inPos == c.in.size()) {
+            c.in.clear();
+            c.inPos = 0;
+        } else if (c.inPos > c.in.size() / 2) {
+            c.in.erase(0, c.inPos);
+            c.inPos = 0;
+        }
+    }
+
+    void handle(const std::shared_ptr<Connection>& connection, const ServiceHeader& request, const char* payload)
+    {
+        Connection& c = *connection;
+        ServiceHeader response;
+        response.id = request.id;
+        response.op = request.op;
+        response.handle = request.handle;
+        ServiceStatus status = ServiceStatus::Ok;
+        ++requests_;
+
+        switch (static_cast<ServiceOp>(request.op)) {
+        case ServiceOp::SetKey:
+            status = keys_.acquire(payload, request.count, response.handle);
+            if (status == ServiceStatus::Ok) {
+                c.handles.push_back(response.handle);
+            }
+            break;
+        case ServiceOp::DropKey: {
+            auto held = std::find(c.handles.begin(), c.handles.end(), request.handle);
+            if (held == c.handles.end()) {
+                status = ServiceStatus::UnknownHandle;
+            } else {
+                c.handles.erase(held);
+                keys_.release(request.handle);
+            }
+            break;
+        }
+        case ServiceOp::Configure:
+            // Within the limits of the command line, since any client may send it; applies from the next batch on
+            if (request.handle > SERVICE_MAX_WINDOW_US || request.count > SERVICE_MAX_BATCH_BLOCKS) {
+                status = ServiceStatus::BadRequest;
+                break;
+            }
+            window_ = request.handle;
+            if (request.count > 0) {
+                batchBlocks_ = request.count;
+            }
+            break;
+        case ServiceOp::Encrypt:
+        case ServiceOp::Decrypt: {
+            std::shared_ptr<const Present> cipher = keys_.find(request.handle);
+            if (!cipher) {
+                status = ServiceStatus::UnknownHandle;
+                break;
+            }
+            const bool decrypt = static_cast<ServiceOp>(request.op) == ServiceOp::Decrypt;
+            const int group = groupFor(request.handle, decrypt, std::move(cipher));
+            std::vector<uint64_t>& blocks = groups_[group].blocks;
+            const size_t offset = blocks.size();
+            blocks.resize(offset + request.count);
+            std::memcpy(blocks.data() + offset, payload, static_cast<size_t>(request.count) * 8);
+            response.count = request.count;
+            enqueue(connection, response, group, offset);
+            pendingBlocks_ += request.count;
+            return;
+        }
+        default:
+            status = ServiceStatus::BadRequest;
+            break;
+        }
+
+        response.status = static_cast<uint8_t>(status);
+        if (c.queued == 0) {
+            appendResponse(c, response, nullptr);
+            writeTo(c);
+        } else {
+            enqueue(connection, response, -1, 0); // Keep it behind the responses already waiting
+        }
+    }
+
+    int groupFor(uint32_t handle, bool decrypt, std::shared_ptr<const Present> cipher)
+    {
+        const uint64_t id = static_cast<uint64_t>(handle) << 1 | (decrypt ? 1 : 0);
+        auto found = groupIndex_.find(id);
+        if (found != groupIndex_.end()) {
+            return found->second;
+        }
+        // The Group objects stay allocated between batches so their buffers keep their capacity
+        if (numGroups_ == groups_.size()) {
+            groups_.emplace_back();
+        }
+        Group& group = groups_[numGroups_];
+        group.cipher = std::move(cipher);
+        group.decrypt = decrypt;
+        groupIndex_[id] = static_cast<int>(numGroups_);
+        return static_cast<int>(numGroups_++);
+    }
+
+    void enqueue(const std::shared_ptr<Connection>& connection, const ServiceHeader& response, int group,
+                 size_t offset)
+    {
+        if (pending_.empty() && window_ > 0) {
+            deadline_ = std::chrono::steady_clock::now() + std::chrono::microseconds(window_);
+            itimerspec timer{};
+            timer.it_value.tv_sec = window_ / 1000000;
+            timer.it_value.tv_nsec = static_cast<long>(window_ % 1000000) * 1000;
+            checked(timerfd_settime(timer_, 0, &timer, nullptr), "timerfd_settime");
+        }
+        pending_.push_back(Pending{connection, response, group, offset});
+        ++connection->queued;
+    }
+
+    void appendResponse(Connection& connection, const ServiceHeader& response, const uint64_t* blocks)
+    {
+        const size_t old = connection.out.size();
+        const size_t payload = blocks ? static_cast<size_t>(response.count) * 8 : 0;
+        connection.out.resize(old + sizeof(ServiceHeader) + payload);
+        putServiceHeader(&connection.out[old], response);
+        if (payload > 0) {
+            std::memcpy(&connection.out[old + sizeof(ServiceHeader)], blocks, payload);
+        }
+    }
+
+    void flush()
+    {
+        if (pending_.empty()) {
+            return;
+        }
+        const itimerspec disarm{};
+        timerfd_settime(timer_, 0, &disarm, nullptr);
+
+        for (size_t g = 0; g < numGroups_; ++g) {
+            const Group& group = groups_[g];
+            uint64_t* blocks = groups_[g].blocks.data();
+            const size_t n = group.blocks.size();
+            auto process = [&group, blocks](size_t begin, size_t end) {
+                if (group.decrypt) {
+                    group.cipher->decryptBlocks(blocks + begin, blocks + begin, end - begin);
+                } else {
+                    group.cipher->encryptBlocks(blocks + begin, blocks + begin, end - begin);
+                }
+            };
+            if (threads_ > 1 && n >= PARALLEL_MIN_BLOCKS) {
+                const size_t tasks = std::min<size_t>(4 * threads_, n / (PARALLEL_MIN_BLOCKS / 4));
+                parallelFor(tasks, threads_, [&](size_t task, unsigned) {
+                    process(n * task / tasks, n * (task + 1) / tasks);
+                });
+            } else {
+                process(0, n);
+            }
+        }
+
+        std::vector<Connection*> touched;
+        for (const Pending& pending : pending_) {
+            Connection& c = *pending.connection;
+            --c.queued;
+            if (c.closed) {
+                continue;
+            }
+            appendResponse(c, pending.response,
+                           pending.group < 0 ? nullptr : groups_[pending.group].blocks.data() + pending.offset);
+            if (!c.touched) {
+                c.touched = true;
+                touched.push_back(&c);
+            }
+        }
+
+        ++batches_;
+        batchedRequests_ += pending_.size();
+        blocks_ += pendingBlocks_;
+        largestBatch_ = std::max<uint64_t>(largestBatch_, pendingBlocks_);
+
+        // The entries hold the connections, so they stay valid while writing even if one is closed
+        for (Connection* c : touched) {
+            c->touched = false;
+            writeTo(*c);
+        }
+        pending_.clear();
+        for (size_t g = 0; g < numGroups_; ++g) {
+            groups_[g].cipher.reset();
+            groups_[g].blocks.clear();
+        }
+        numGroups_ = 0;
+        groupIndex_.clear();
+        pendingBlocks_ = 0;
+    }
+
+    void writeTo(Connection& c)
+    {
+        while (c.outPos < c.out.size()) {
+            const ssize_t w = send(c.fd, &c.out[c.outPos], c.out.size() - c.outPos, MSG_NOSIGNAL);
+            if (w >= 0) {
+                c.outPos += w;
+            } else if (errno == EINTR) {
+                continue;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            } else {
+                close(c);
+                return;
+            }
+        }
+        if (c.outPos == c.out.size()) {
+            c.out.clear();
+            c.outPos = 0;
+            if (c.eof && c.queued == 0 && !c.parsing) {
+                close(c);
+                return;
+            }
+        } else if (c.outPos > c.out.size() / 2) {
+            c.out.erase(0, c.outPos);
+            c.outPos = 0;
+        }
+        updateEvents(c);
+    }
+
+    std::string path_;
+    uint32_t window_;      ///< Batch window in microseconds
+    uint32_t batchBlocks_; ///< Blocks that flush a batch before its window expires
+    unsigned threads_;
+    KeyCache keys_;
+
+    int epoll_ = -1;
+    int listen_ = -1;
+    int timer_ = -1;
+    int signal_ = -1;
+    bool bound_ = false;
+    std::unordered_map<int, std::shared_ptr<Connection>> connections_;
+
+    std::vector<Pending> pending_; ///< In arrival order, which is the response order of every connection
+    std::vector<Group> groups_;
+    size_t numGroups_ = 0;
+    std::unordered_map<uint64_t, int> groupIndex_;
+    size_t pendingBlocks_ = 0;
+    std::chrono::steady_clock::time_point deadline_;
+
+    uint64_t accepted_ = 0;
+    uint64_t requests_ = 0;
+    uint64_t batches_ = 0;
+    uint64_t batchedRequests_ = 0;
+    uint64_t blocks_ = 0;
+    uint64_t largestBatch_ = 0;
+};
+
+int main(int argc, char* argv[]) {
+
+    std::string path = SERVICE_DEFAULT_SOCKET;
+    uint32_t window = DEFAULT_WINDOW_US;
+    uint32_t batch_blocks = DEFAULT_BATCH_BLOCKS;
+    unsigned threads = defaultThreadCount();
+    size_t max_keys = DEFAULT_MAX_KEYS;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) {
+            path = argv[++i];
+        } else if ((arg == "--window-us" || arg == "--batch-blocks" || arg == "--threads" || arg == "--max-keys") &&
+                   i + 1 < argc) {
+            std::string value = argv[++i];
+            unsigned long long number = 0;
+            try {
+                number = std::stoull(value, nullptr, 0);
+            } catch (const std::exception&) {
+                std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+                return 1;
+            }
+            if (arg == "--window-us") {
+                window = static_cast<uint32_t>(std::min<unsigned long long>(number, SERVICE_MAX_WINDOW_US));
+            } else if (arg == "--batch-blocks") {
+                batch_blocks =
+                    static_cast<uint32_t>(std::min<unsigned long long>(std::max(number, 1ULL), SERVICE_MAX_BATCH_BLOCKS));
+            } else if (arg == "--threads") {
+                threads = static_cast<unsigned>(std::min(std::max(number, 1ULL), 1024ULL));
+            } else {
+                max_keys = static_cast<size_t>(std::max(number, 1ULL));
+            }
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    try {
+        Server server(path, window, batch_blocks, threads, max_keys);
+        std::cout << "Listening on " << path << " (window " << window << " us, " << batch_blocks << " blocks, "
+                  << threads << " threads, SIMD engine " << Present::simdInstructionSet() << ")" << std::endl;
+        server.run();
+        server.printStats(std::cout);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
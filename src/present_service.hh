@@ -0,0 +1,102 @@
+/*
+ * File: present_service.hh
+ *
+ * Description:    Wire format of the local encryption service
+ *
+ * present_server listens on a UNIX stream socket. Every request and every
+ * response is a 16-byte ServiceHeader followed by its payload, in host byte
+ * order since both ends run on the same machine:
+ *
+ *   SetKey     payload: the key (10 or 16 bytes, count = its length)
+ *              response: handle of the expanded schedule, no payload
+ *   DropKey    handle to release, no payload either way
+ *   Encrypt    handle and count blocks of 8 bytes; the response carries
+ *   Decrypt    count blocks back, in the same order
+ *   Configure  handle = batch window in microseconds, count = blocks that
+ *              flush a batch early (0 keeps the current value); values above
+ *              SERVICE_MAX_WINDOW_US or SERVICE_MAX_BATCH_BLOCKS are refused
+ *
+ * Responses echo the request id and come back in request order on every
+ * connection. A response with a status other than Ok has no payload. Handles
+ * are shared: setting a key that is already cached returns its handle and
+ * takes another reference to it, and a connection's references are dropped
+ * when it closes.
+ *
+ * Copyright (c) 2025 Ahmet Çobanoğlu
+ * All rights reserved.
+ *
+ * This file is proprietary and confidential. Unauthorized copying, distribution,
+ * modification, or use of this file, via any medium, is strictly prohibited
+ * without express written permission from the copyright holder.
+ */
+
+#ifndef A651863B_4E0A_4FAE_B5A4_906E3F109065
+#define A651863B_4E0A_4FAE_B5A4_906E3F109065
+
+#include <cstdint>
+#include <cstring>
+
+const char* const SERVICE_DEFAULT_SOCKET = "/tmp/present.sock";
+const uint32_t SERVICE_MAX_BLOCKS = 1 << 16; // Blocks per request; larger requests close the connection
+const uint32_t SERVICE_MAX_KEY_BYTES = 16;
+const uint32_t SERVICE_MAX_WINDOW_US = 10000000;
+const uint32_t SERVICE_MAX_BATCH_BLOCKS = 1 << 24;
+
+enum class ServiceOp : uint8_t {
+    SetKey = 1,
+    DropKey = 2,
+    Encrypt = 3,
+    Decrypt = 4,
+    Configure = 5
+};
+
+enum class ServiceStatus : uint8_t {
+    Ok = 0,
+    BadRequest = 1,    ///< Unknown op, invalid key length or Configure value out of range
+    UnknownHandle = 2, ///< No schedule under this handle (or not held by this connection, for DropKey)
+    TooManyKeys = 3    ///< The key cache is full
+};
+
+/**
+ * @brief Header of every request and response
+ */
+struct ServiceHeader {
+    uint32_t id = 0;     ///< Chosen by the client, echoed in the response
+    uint8_t op = 0;      ///< ServiceOp
+    uint8_t status = 0;  ///< ServiceStatus, 0 in requests
+    uint16_t reserved = 0;
+    uint32_t handle = 0; ///< Key handle, or the window of Configure
+    uint32_t count = 0;  ///< Payload size in blocks (key bytes for SetKey)
+};
+
+static_assert(sizeof(ServiceHeader) == 16, "ServiceHeader is sent as is");
+
+/**
+ * @brief Payload bytes following a request header
+ */
+inline size_t servicePayloadBytes(const ServiceHeader& header)
+{
+    switch (static_cast<ServiceOp>(header.op)) {
+    case ServiceOp::SetKey:
+        return header.count;
+    case ServiceOp::Encrypt:
+    case ServiceOp::Decrypt:
+        return static_cast<size_t>(header.count) * 8;
+    default:
+        return 0;
+    }
+}
+
+inline void putServiceHeader(char* out, const ServiceHeader& header)
+{
+    std::memcpy(out, &header, sizeof(header));
+}
+
+inline ServiceHeader getServiceHeader(const char* in)
+{
+    ServiceHeader header;
+    std::memcpy(&header, in, sizeof(header));
+    return header;
+}
+
+#endif /* A651863B_4E0A_4FAE_B5A4_906E3F109065 */
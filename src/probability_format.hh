@@ -0,0 +1,41 @@
+/*
+ * File: probability_format.hh
+ *
+ * Description:    Printing probabilities as powers of two
+ *
+ * The experiments and tools report the small probabilities they count or
+ * propagate as 2^(-x.xx), which is how characteristics and biases are
+ * compared in the literature.
+ *
+ * Copyright (c) 2025 Ahmet Çobanoğlu
+ * All rights reserved.
+ *
+ * This file is proprietary and confidential. Unauthorized copying, distribution,
+ * modification, or use of this file, via any medium, is strictly prohibited
+ * without express written permission from the copyright holder.
+ */
+
+#ifndef AB15BD38_CE3A_464F_A9CC_19735A945AA4
+#define AB15BD38_CE3A_464F_A9CC_19735A945AA4
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+/**
+ * @brief A probability (or bias) as 2^(-x.xx), "0" for zero
+ */
+inline std::string log2String(double p)
+{
+    std::ostringstream out;
+    if (p <= 0.0) {
+        out << "0";
+    } else {
+        out << "2^(-" << std::fixed << std::setprecision(2) << std::max(0.0, -std::log2(p)) << ")";
+    }
+    return out.str();
+}
+
+#endif /* AB15BD38_CE3A_464F_A9CC_19735A945AA4 */
@@ -0,0 +1,368 @@
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+
+#include "present.hh"
+#include "present_rng.hh"
+#include "thread_pool.hh"
+#include "binomial_interval.hh"
+#include "nibble_activity.hh"
+#include "probability_format.hh"
+#include "hex_format.hh"
+
+// Related-key counterpart of differential_experiment: pairs of plaintexts
+// (p, p ^ alpha) are encrypted under pairs of keys (K, K ^ delta) and the
+// ciphertext differences are counted against beta, for 80- and 128-bit keys.
+//
+// Every key pair is set up by Present::setRelatedKeys(), which expands both
+// schedules in one pass: the related one is carried as a register difference
+// that only needs an S-box lookup where it enters the key-schedule S-boxes.
+// Key k is words 2k and 2k + 1 of sub-stream 0 of the seeded generator and
+// its plaintexts are words [k N, (k + 1) N) of sub-stream 1, so a task of
+// KEYS_PER_TASK keys draws its keys and plaintexts in bulk with one jump each
+// and the results do not depend on the thread count.
+//
+// The run has two parts:
+//   1. The first SAMPLE_KEYS key pairs, traced serially: the round-key
+//      differences, the state difference after every round for
+//      TRACE_PLAINTEXTS plaintexts per key, and the most frequent ciphertext
+//      differences, the first of which is beta unless --beta is given.
+//   2. All key pairs on all cores: the right pairs of (alpha, beta) and, per
+//      round key, how often its difference is zero, its mean weight and how
+//      many key-schedule S-boxes the difference passes through.
+
+// Constants
+const uint64_t DEFAULT_SEED = 0x50524553454E5421ULL;
+const size_t KEYS_PER_TASK = 4096;   // Key pairs per parallel task
+const size_t SAMPLE_KEYS = 4096;     // Key pairs traced in part 1
+const size_t TRACE_PLAINTEXTS = 4;   // Traced plaintexts per sampled key
+const size_t BATCH = 1024;           // Pairs encrypted at a time
+const int TOP_DIFFERENCES = 5;       // Ciphertext differences listed
+
+// Schedule S-boxes the difference passes on its way to round key r + 1: the
+// S-box outputs are the top nibble (two for 128-bit keys) of the next round
+// key, and an S-box has an output difference exactly when it has an input one
+inline int activeScheduleSboxes(uint64_t nextRoundKeyDiff, int keyBits) {
+    return keyBits == 80 ? (nextRoundKeyDiff >> 60 != 0)
+                         : (((nextRoundKeyDiff >> 60) & 0xF) != 0) + (((nextRoundKeyDiff >> 56) & 0xF) != 0);
+}
+
+// The key bytes of the next key from a stream positioned at it
+void nextKey(Rng& gen, uint8_t* key, size_t keyLength) {
+    const uint64_t words[2] = {gen.next(), gen.next()};
+    for (size_t i = 0; i < keyLength; ++i) {
+        key[i] = static_cast<uint8_t>(words[i / 8] >> (8 * (i % 8)));
+    }
+}
+
+// Most frequent values of a sample, with their counts
+std::vector<std::pair<uint64_t, size_t>> mostFrequent(std::vector<uint64_t> values, size_t top) {
+    std::sort(values.begin(), values.end());
+    std::vector<std::pair<uint64_t, size_t>> runs;
+    for (size_t i = 0; i < values.size();) {
+        size_t j = i;
+        while (j < values.size() && values[j] == values[i]) {
+            ++j;
+        }
+        runs.push_back({values[i], j - i});
+        i = j;
+    }
+    std::stable_sort(runs.begin(), runs.end(),
+                     [](const std::pair<uint64_t, size_t>& a, const std::pair<uint64_t, size_t>& b) {
+                         return a.second > b.second;
+                     });
+    if (runs.size() > top) {
+        runs.resize(top);
+    }
+    return runs;
+}
+
+// Per-thread state: the cipher pair, buffers and private counters
+struct WorkerState {
+    WorkerState(Present::KeySize keySize, int rounds)
+        : cipher(keySize, rounds), related(keySize, rounds), pairs(2 * BATCH), key(16), hits(0),
+          zeroRoundKeys(rounds + 1, 0), roundKeyWeight(rounds + 1, 0), scheduleSboxes(rounds, 0) {}
+
+    Present cipher;
+    Present related;
+    std::vector<uint64_t> pairs;          // Pair buffer
+    std::vector<uint8_t> key;             // Key bytes of the current key
+    uint64_t hits;                        // Right pairs
+    std::vector<uint64_t> zeroRoundKeys;  // Keys with a zero difference in round key r
+    std::vector<uint64_t> roundKeyWeight; // Summed weight of the difference of round key r
+    std::vector<uint64_t> scheduleSboxes; // Active schedule S-boxes between round keys r and r + 1
+};
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--key-size 80|128] [--key-diff <hex>] [--alpha <diff>] [--beta <diff>]"
+              << " [--rounds <r>] [--keys <k>] [--plaintexts <n>] [--seed <value>]"
+              << " [--rng splitmix|philox|present-ctr]" << std::endl;
+    std::cerr << "  --key-diff takes 20 or 32 hex digits in key byte order (default: the top bit of byte 0," << std::endl;
+    std::cerr << "  register bit 0). Without --beta the most frequent ciphertext difference of the sample is used." << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+
+    Present::KeySize key_size = Present::KeySize::KEY_80;
+    std::vector<uint8_t> key_diff;
+    uint64_t alpha = 0;
+    uint64_t beta = 0;
+    bool beta_given = false;
+    int rounds = 4;
+    uint64_t num_keys = 1ULL << 20;
+    uint64_t n_plaintexts = 64; // Per key pair
+    uint64_t seed = DEFAULT_SEED;
+    std::string rng_name = "splitmix";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--rng" && i + 1 < argc) {
+            rng_name = argv[++i];
+        } else if (arg == "--key-diff" && i + 1 < argc) {
+            std::string value = argv[++i];
+            try {
+                key_diff = parseHex(value);
+            } catch (const std::exception&) {
+                std::cerr << "Invalid value for --key-diff: " << value << std::endl;
+                return 1;
+            }
+        } else if ((arg == "--key-size" || arg == "--alpha" || arg == "--beta" || arg == "--rounds" ||
+                    arg == "--keys" || arg == "--plaintexts" || arg == "--seed") && i + 1 < argc) {
+            std::string value = argv[++i];
+            unsigned long long number = 0;
+            try {
+                number = std::stoull(value, nullptr, 0);
+            } catch (const std::exception&) {
+                std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+                return 1;
+            }
+            if (arg == "--key-size") {
+                if (number != 80 && number != 128) {
+                    std::cerr << "--key-size must be 80 or 128" << std::endl;
+                    return 1;
+                }
+                key_size = number == 80 ? Present::KeySize::KEY_80 : Present::KeySize::KEY_128;
+            } else if (arg == "--alpha") {
+                alpha = number;
+            } else if (arg == "--beta") {
+                beta = number;
+                beta_given = true;
+            } else if (arg == "--rounds") {
+                rounds = static_cast<int>(std::min(std::max(number, 1ULL), 31ULL));
+            } else if (arg == "--keys") {
+                num_keys = std::min(std::max(number, 1ULL), 1ULL << 40);
+            } else if (arg == "--plaintexts") {
+                n_plaintexts = std::min(std::max(number, 1ULL), 1ULL << 40);
+            } else {
+                seed = number;
+            }
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    const int key_bits = static_cast<int>(key_size);
+    const size_t key_length = static_cast<size_t>(key_bits) / 8;
+    if (key_diff.empty()) {
+        key_diff.assign(key_length, 0);
+        key_diff[0] = 0x80;
+    }
+    if (key_diff.size() != key_length) {
+        std::cerr << "--key-diff needs " << 2 * key_length << " hex digits for " << key_bits << "-bit keys."
+                  << std::endl;
+        return 1;
+    }
+
+    std::unique_ptr<Rng> root;
+    try {
+        root = Rng::create(rng_name, seed);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+    const unsigned num_threads = defaultThreadCount();
+
+    std::cout << "Starting related-key differential experiment on " << rounds << "-round PRESENT-" << key_bits
+              << "..." << std::endl;
+    std::cout << "Parameters:" << std::endl;
+    std::cout << "  Key Pairs: " << num_keys << std::endl;
+    std::cout << "  Plaintext Pairs per Key Pair: " << n_plaintexts << std::endl;
+    std::cout << "  Cipher Rounds: " << rounds << std::endl;
+    std::cout << "  Key Difference: ";
+    for (uint8_t b : key_diff) {
+        std::cout << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(b);
+    }
+    std::cout << std::dec << std::endl;
+    std::cout << "  Alpha (Input Difference): " << hex64(alpha) << std::endl;
+    std::cout << "  Seed: " << hex64(seed) << std::endl;
+    std::cout << "  Generator: " << rng_name << std::endl;
+    std::cout << "  Threads: " << num_threads << std::endl;
+    std::cout << "--------------------------------------------------" << std::endl;
+
+    // Part 1: trace the first key pairs serially
+    const size_t sample_keys = static_cast<size_t>(std::min<uint64_t>(num_keys, SAMPLE_KEYS));
+    const size_t traced = static_cast<size_t>(std::min<uint64_t>(n_plaintexts, TRACE_PLAINTEXTS));
+    std::vector<std::vector<uint64_t>> sample_round_keys(rounds + 1, std::vector<uint64_t>(sample_keys));
+    std::vector<uint64_t> sample_outputs;
+    std::vector<uint64_t> state_zero(rounds + 1, 0);
+    std::vector<uint64_t> state_weight(rounds + 1, 0);
+    std::vector<uint64_t> state_active(rounds + 1, 0);
+    {
+        WorkerState state(key_size, rounds);
+        std::unique_ptr<Rng> key_gen = root->split(0);
+        std::vector<uint64_t> first(rounds + 1);
+        std::vector<uint64_t> second(rounds + 1);
+        for (size_t k = 0; k < sample_keys; ++k) {
+            nextKey(*key_gen, state.key.data(), key_length);
+            state.cipher.setRelatedKeys(state.key.data(), key_diff.data(), key_length, state.related);
+            for (int r = 0; r <= rounds; ++r) {
+                sample_round_keys[r][k] = state.cipher.roundKey(r) ^ state.related.roundKey(r);
+            }
+            std::unique_ptr<Rng> pt_gen = root->split(1);
+            pt_gen->discard(k * n_plaintexts);
+            for (size_t i = 0; i < traced; ++i) {
+                const uint64_t p = pt_gen->next();
+                const uint64_t c1 = state.cipher.encryptTrace(p, first.data());
+                const uint64_t c2 = state.related.encryptTrace(p ^ alpha, second.data());
+                for (int r = 0; r <= rounds; ++r) {
+                    const uint64_t d = first[r] ^ second[r];
+                    state_zero[r] += d == 0;
+                    state_weight[r] += static_cast<uint64_t>(__builtin_popcountll(d));
+                    state_active[r] += static_cast<uint64_t>(activeNibbles(d));
+                }
+                sample_outputs.push_back(c1 ^ c2);
+            }
+        }
+    }
+    const auto top_outputs = mostFrequent(sample_outputs, TOP_DIFFERENCES);
+    if (!beta_given) {
+        beta = top_outputs.front().first;
+    }
+
+    // Part 2: every key pair, in tasks of KEYS_PER_TASK
+    std::vector<WorkerState> workers(num_threads, WorkerState(key_size, rounds));
+    const uint64_t num_tasks = (num_keys + KEYS_PER_TASK - 1) / KEYS_PER_TASK;
+    auto start = std::chrono::steady_clock::now();
+    parallelFor(static_cast<size_t>(num_tasks), num_threads, [&](size_t task, unsigned w) {
+        WorkerState& state = workers[w];
+        const uint64_t first_key = static_cast<uint64_t>(task) * KEYS_PER_TASK;
+        const uint64_t last_key = std::min<uint64_t>(first_key + KEYS_PER_TASK, num_keys);
+        std::unique_ptr<Rng> key_gen = root->split(0);
+        key_gen->discard(2 * first_key);
+        std::unique_ptr<Rng> pt_gen = root->split(1);
+        pt_gen->discard(first_key * n_plaintexts);
+        uint64_t* first = state.pairs.data();
+        uint64_t* second = state.pairs.data() + BATCH;
+
+        for (uint64_t k = first_key; k < last_key; ++k) {
+            nextKey(*key_gen, state.key.data(), key_length);
+            state.cipher.setRelatedKeys(state.key.data(), key_diff.data(), key_length, state.related);
+
+            uint64_t previous = state.cipher.roundKey(0) ^ state.related.roundKey(0);
+            for (int r = 0; r <= rounds; ++r) {
+                const uint64_t d = previous;
+                if (r < rounds) {
+                    previous = state.cipher.roundKey(r + 1) ^ state.related.roundKey(r + 1);
+                    state.scheduleSboxes[r] += static_cast<uint64_t>(activeScheduleSboxes(previous, key_bits));
+                }
+                state.zeroRoundKeys[r] += d == 0;
+                state.roundKeyWeight[r] += static_cast<uint64_t>(__builtin_popcountll(d));
+            }
+
+            for (uint64_t done = 0; done < n_plaintexts; done += BATCH) {
+                const size_t count = static_cast<size_t>(std::min<uint64_t>(BATCH, n_plaintexts - done));
+                pt_gen->fillPlaintexts(first, count);
+                for (size_t i = 0; i < count; ++i) {
+                    second[i] = first[i] ^ alpha;
+                }
+                state.cipher.encryptBlocks(first, first, count);
+                state.related.encryptBlocks(second, second, count);
+                uint64_t hits = 0;
+                for (size_t i = 0; i < count; ++i) {
+                    hits += (first[i] ^ second[i]) == beta;
+                }
+                state.hits += hits;
+            }
+        }
+    });
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    uint64_t hits = 0;
+    std::vector<uint64_t> zero_round_keys(rounds + 1, 0);
+    std::vector<uint64_t> round_key_weight(rounds + 1, 0);
+    std::vector<uint64_t> schedule_sboxes(rounds, 0);
+    for (const auto& state : workers) {
+        hits += state.hits;
+        for (int r = 0; r <= rounds; ++r) {
+            zero_round_keys[r] += state.zeroRoundKeys[r];
+            round_key_weight[r] += state.roundKeyWeight[r];
+            if (r < rounds) {
+                schedule_sboxes[r] += state.scheduleSboxes[r];
+            }
+        }
+    }
+
+    const double keys = static_cast<double>(num_keys);
+    std::cout << "Round-key differences (all " << num_keys << " key pairs; most frequent among the first "
+              << sample_keys << "):" << std::endl;
+    std::cout << "  Round key | P(zero) | Mean weight | Schedule S-boxes active after | Most frequent difference"
+              << std::endl;
+    for (int r = 0; r <= rounds; ++r) {
+        const auto top = mostFrequent(sample_round_keys[r], 1).front();
+        std::cout << "  " << std::setw(9) << std::setfill(' ') << r << " | " << std::fixed << std::setprecision(4)
+                  << std::setw(7) << zero_round_keys[r] / keys << " | " << std::setw(11) << std::setprecision(2)
+                  << round_key_weight[r] / keys << " | ";
+        if (r < rounds) {
+            std::cout << std::setw(29) << schedule_sboxes[r] / keys;
+        } else {
+            std::cout << std::setw(29) << "-";
+        }
+        std::cout << std::defaultfloat << " | " << hex64(top.first) << " (P "
+                  << log2String(static_cast<double>(top.second) / sample_keys) << ")" << std::endl;
+    }
+
+    const double traces = static_cast<double>(sample_keys * traced);
+    std::cout << "State differences after each round (" << sample_keys * traced << " traced pairs):" << std::endl;
+    std::cout << "  Round |   P(zero) | Mean weight | Mean active nibbles" << std::endl;
+    for (int r = 0; r <= rounds; ++r) {
+        std::cout << "  " << std::setw(5) << std::setfill(' ') << r << " | " << std::setw(9)
+                  << log2String(state_zero[r] / traces) << " | " << std::fixed << std::setprecision(2)
+                  << std::setw(11) << state_weight[r] / traces << " | " << std::setw(19) << state_active[r] / traces
+                  << std::defaultfloat << std::endl;
+    }
+    std::cout << "Most frequent ciphertext differences (traced pairs):" << std::endl;
+    for (const auto& d : top_outputs) {
+        std::cout << "  " << hex64(d.first) << ": " << d.second << " (P " << log2String(d.second / traces) << ")"
+                  << std::endl;
+    }
+
+    const uint64_t trials = num_keys * n_plaintexts;
+    const BinomialInterval ci = wilsonInterval(hits, trials);
+    std::cout << "--------------------------------------------------" << std::endl;
+    std::cout << "Experiment Results:" << std::endl;
+    std::cout << "Beta (Output Difference): " << hex64(beta) << (beta_given ? "" : " (most frequent in the sample)")
+              << std::endl;
+    // A random 64-bit difference repeats in a sample of this size about as often as not
+    if (!beta_given && top_outputs.front().second < 3) {
+        std::cout << "No ciphertext difference stands out in the sample; beta is arbitrary, pass --beta." << std::endl;
+    }
+    std::cout << "Right pairs: " << hits << " of " << trials << std::endl;
+    std::cout << "Experimental Probability: " << log2String(ci.estimate) << ", 95% confidence interval (Wilson): ["
+              << log2String(ci.low) << ", " << log2String(ci.high) << "]" << std::endl;
+    std::cout << "Processed " << num_keys << " key pairs in " << std::fixed << std::setprecision(2)
+              << elapsed.count() << " s (" << keys / std::max(elapsed.count(), 1e-9) / 1e6 << " M key pairs/s, "
+              << trials / std::max(elapsed.count(), 1e-9) / 1e6 << " M plaintext pairs/s)" << std::defaultfloat
+              << std::endl;
+    std::cout << "--------------------------------------------------" << std::endl;
+    std::cout << "Experiment finished." << std::endl;
+
+    return 0;
+}
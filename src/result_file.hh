@@ -0,0 +1,205 @@
+/*
+ * File: result_file.hh
+ *
+ * Description:    Checkpoint and result files of the differential experiment
+ *
+ * A result file holds the parameters of a run and, for a contiguous range of
+ * its keys, the plaintexts counted so far and the right pairs among them.
+ * differential_experiment rewrites it at every checkpoint and resumes from
+ * it; merge_results combines the files of the shards of one run. Every key
+ * draws from its own generator stream, so the counters of a key do not depend
+ * on the shard or on how often the run was interrupted.
+ *
+ * Layout (all integers little-endian):
+ *   8 bytes   magic "PRESDIFF"
+ *   u32       format version
+ *   u32       rounds
+ *   u64       alpha, beta, seed, plaintexts per key
+ *   u32       keys of the run, first key of the file, keys in the file
+ *   u32       length of the generator name, then its bytes
+ *   u64 x 2   plaintexts counted and right pairs, for every key of the file
+ *   u64       FNV-1a hash of everything before it
+ *
+ * Files are written to a temporary name and renamed over the old one, so a
+ * preempted process leaves either the previous or the new checkpoint.
+ *
+ * Copyright (c) 2025 Ahmet Çobanoğlu
+ * All rights reserved.
+ *
+ * This file is proprietary and confidential. Unauthorized copying, distribution,
+ * modification, or use of this file, via any medium, is strictly prohibited
+ * without express written permission from the copyright holder.
+ */
+
+#ifndef A9F52266_5151_4451_924C_F50D4C9DD506
+#define A9F52266_5151_4451_924C_F50D4C9DD506
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+const char RESULT_FILE_MAGIC[8] = {'P', 'R', 'E', 'S', 'D', 'I', 'F', 'F'};
+const uint32_t RESULT_FILE_VERSION = 1;
+
+/**
+ * @brief Counters of a range of keys of one experiment
+ */
+struct ExperimentResult {
+    uint32_t rounds = 0;
+    uint64_t alpha = 0;
+    uint64_t beta = 0;
+    uint64_t seed = 0;
+    std::string rng;               ///< Generator name as given to Rng::create()
+    uint64_t plaintextsPerKey = 0; ///< N of the run
+    uint32_t totalKeys = 0;        ///< Keys of the whole run
+    uint32_t firstKey = 0;         ///< Key index of done[0] and hits[0]
+    std::vector<uint64_t> done;    ///< Plaintexts counted, per key
+    std::vector<uint64_t> hits;    ///< Right pairs among them, per key
+
+    /**
+     * @brief True if both describe the same run (every parameter but the key range)
+     */
+    bool sameExperiment(const ExperimentResult& other) const
+    {
+        return rounds == other.rounds && alpha == other.alpha && beta == other.beta && seed == other.seed &&
+               rng == other.rng && plaintextsPerKey == other.plaintextsPerKey && totalKeys == other.totalKeys;
+    }
+};
+
+namespace result_file_detail {
+
+inline uint64_t fnv1a(const std::string& bytes)
+{
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (unsigned char c : bytes) {
+        h = (h ^ c) * 0x100000001B3ULL;
+    }
+    return h;
+}
+
+inline void put(std::string& out, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+// Reads fixed-width fields from a buffer, throwing once it runs out
+struct Reader {
+    const std::string& in;
+    size_t pos;
+
+    uint64_t get(int bytes)
+    {
+        if (in.size() - pos < static_cast<size_t>(bytes)) {
+            throw std::runtime_error("truncated result file");
+        }
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; ++i) {
+            value |= static_cast<uint64_t>(static_cast<unsigned char>(in[pos + i])) << (8 * i);
+        }
+        pos += bytes;
+        return value;
+    }
+};
+
+} // namespace result_file_detail
+
+/**
+ * @brief Write a result file, replacing path only once the new file is complete
+ *
+ * @throws std::runtime_error if the file cannot be written
+ */
+inline void writeResultFile(const std::string& path, const ExperimentResult& result)
+{
+    using result_file_detail::put;
+    std::string out(RESULT_FILE_MAGIC, sizeof(RESULT_FILE_MAGIC));
+    put(out, RESULT_FILE_VERSION, 4);
+    put(out, result.rounds, 4);
+    put(out, result.alpha, 8);
+    put(out, result.beta, 8);
+    put(out, result.seed, 8);
+    put(out, result.plaintextsPerKey, 8);
+    put(out, result.totalKeys, 4);
+    put(out, result.firstKey, 4);
+    put(out, result.done.size(), 4);
+    put(out, result.rng.size(), 4);
+    out += result.rng;
+    for (size_t k = 0; k < result.done.size(); ++k) {
+        put(out, result.done[k], 8);
+        put(out, result.hits[k], 8);
+    }
+    put(out, result_file_detail::fnv1a(out), 8);
+
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+        file.flush();
+        if (!file) {
+            throw std::runtime_error("cannot write " + tmp);
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("cannot rename " + tmp + " to " + path);
+    }
+}
+
+/**
+ * @brief Read a result file
+ *
+ * @throws std::runtime_error if the file cannot be read, is not a result file or is corrupt
+ */
+inline ExperimentResult readResultFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    const std::string in((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (in.size() < sizeof(RESULT_FILE_MAGIC) + 8 ||
+        in.compare(0, sizeof(RESULT_FILE_MAGIC), RESULT_FILE_MAGIC, sizeof(RESULT_FILE_MAGIC)) != 0) {
+        throw std::runtime_error(path + " is not a result file");
+    }
+    const std::string body = in.substr(0, in.size() - 8);
+    result_file_detail::Reader tail{in, in.size() - 8};
+    if (tail.get(8) != result_file_detail::fnv1a(body)) {
+        throw std::runtime_error(path + " is corrupt (checksum mismatch)");
+    }
+
+    result_file_detail::Reader r{body, sizeof(RESULT_FILE_MAGIC)};
+    if (r.get(4) != RESULT_FILE_VERSION) {
+        throw std::runtime_error(path + " has an unsupported format version");
+    }
+    ExperimentResult result;
+    result.rounds = static_cast<uint32_t>(r.get(4));
+    result.alpha = r.get(8);
+    result.beta = r.get(8);
+    result.seed = r.get(8);
+    result.plaintextsPerKey = r.get(8);
+    result.totalKeys = static_cast<uint32_t>(r.get(4));
+    result.firstKey = static_cast<uint32_t>(r.get(4));
+    const size_t keys = static_cast<size_t>(r.get(4));
+    const size_t name = static_cast<size_t>(r.get(4));
+    if (body.size() - r.pos < name) {
+        throw std::runtime_error("truncated result file");
+    }
+    result.rng = body.substr(r.pos, name);
+    r.pos += name;
+    if (body.size() - r.pos != 16 * keys || static_cast<uint64_t>(result.firstKey) + keys > result.totalKeys) {
+        throw std::runtime_error(path + " has an inconsistent key range");
+    }
+    result.done.resize(keys);
+    result.hits.resize(keys);
+    for (size_t k = 0; k < keys; ++k) {
+        result.done[k] = r.get(8);
+        result.hits[k] = r.get(8);
+    }
+    return result;
+}
+
+#endif /* A9F52266_5151_4451_924C_F50D4C9DD506 */
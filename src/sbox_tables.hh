@@ -0,0 +1,90 @@
+/*
+ * File: sbox_tables.hh
+ *
+ * Description:    Difference distribution and linear approximation tables of the PRESENT S-box
+ *
+ * DDT[a][b] counts the inputs x with S(x) ^ S(x ^ a) == b, built at compile
+ * time from Present::SBOX. The trail search works with the weight of an
+ * entry, -log2(DDT[a][b] / 16), which is an integer for every non-zero entry
+ * of the PRESENT S-box (the counts are 2, 4 and 16).
+ *
+ * LAT[a][b] is the number of inputs x with parity(a & x) == parity(b & S(x))
+ * minus 8, so the correlation of the approximation is LAT[a][b] / 8.
+ *
+ * Copyright (c) 2025 Ahmet Çobanoğlu
+ * All rights reserved.
+ *
+ * This file is proprietary and confidential. Unauthorized copying, distribution,
+ * modification, or use of this file, via any medium, is strictly prohibited
+ * without express written permission from the copyright holder.
+ */
+
+#ifndef FBA3801A_647A_439B_A4F8_0D5801FD5D02
+#define FBA3801A_647A_439B_A4F8_0D5801FD5D02
+
+#include "present.hh"
+
+/**
+ * @brief A 16 x 16 table of counts over the S-box inputs
+ */
+struct SboxTable {
+    int entry[16][16];
+};
+
+/**
+ * @brief Build the difference distribution table of Present::SBOX
+ */
+constexpr SboxTable makeDifferenceTable()
+{
+    SboxTable ddt{};
+    for (int a = 0; a < 16; ++a) {
+        for (int x = 0; x < 16; ++x) {
+            ddt.entry[a][Present::SBOX[x] ^ Present::SBOX[x ^ a]] += 1;
+        }
+    }
+    return ddt;
+}
+
+constexpr SboxTable DDT = makeDifferenceTable();
+
+/**
+ * @brief -log2 of the probability of a DDT entry, or -1 if the entry is zero
+ *        or not a power of two
+ */
+constexpr int differenceWeight(int count)
+{
+    int weight = 4;
+    while (count > 1 && count % 2 == 0) {
+        count /= 2;
+        --weight;
+    }
+    return count == 1 ? weight : -1;
+}
+
+/**
+ * @brief Build the linear approximation table of Present::SBOX
+ */
+constexpr SboxTable makeLinearTable()
+{
+    SboxTable lat{};
+    for (int a = 0; a < 16; ++a) {
+        for (int b = 0; b < 16; ++b) {
+            int agree = 0;
+            for (int x = 0; x < 16; ++x) {
+                int bits = (a & x) ^ (b & Present::SBOX[x]);
+                bits ^= bits >> 2;
+                bits ^= bits >> 1;
+                agree += (bits & 1) == 0;
+            }
+            lat.entry[a][b] = agree - 8;
+        }
+    }
+    return lat;
+}
+
+constexpr SboxTable LAT = makeLinearTable();
+
+static_assert(DDT.entry[0][0] == 16, "the zero difference passes with probability one");
+static_assert(LAT.entry[0][0] == 8, "the empty mask approximation always holds");
+
+#endif /* FBA3801A_647A_439B_A4F8_0D5801FD5D02 */
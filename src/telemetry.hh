@@ -0,0 +1,326 @@
+/*
+ * File: telemetry.hh
+ *
+ * Description:    Progress and hot-path counters for long experiment runs
+ *
+ * Every worker owns a cache-line sized block of counters (pairs counted,
+ * right pairs and the nanoseconds spent drawing plaintexts, encrypting and
+ * comparing) that only it writes, once per task, with relaxed loads and
+ * stores. A reporter thread sums the blocks every interval and prints the
+ * throughput, the ETA of the queued work, the split of the time between the
+ * phases and the progress of the keys, and can export the same snapshot as
+ * JSON for dashboards. Nothing here runs on the encryption path itself: the
+ * experiments hold a null Telemetry when it is disabled and test for it once
+ * per task.
+ *
+ * Copyright (c) 2025 Ahmet Çobanoğlu
+ * All rights reserved.
+ *
+ * This file is proprietary and confidential. Unauthorized copying, distribution,
+ * modification, or use of this file, via any medium, is strictly prohibited
+ * without express written permission from the copyright holder.
+ */
+
+#ifndef D46FEEC4_CA58_48F6_B8C7_7C2BA2233294
+#define D46FEEC4_CA58_48F6_B8C7_7C2BA2233294
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Counters of one worker, written by that worker only
+ */
+struct alignas(64) WorkerTelemetry {
+    std::atomic<uint64_t> trials{0};       ///< Pairs counted
+    std::atomic<uint64_t> hits{0};         ///< Right pairs among them
+    std::atomic<uint64_t> rngNanos{0};     ///< Drawing plaintexts and forming pairs
+    std::atomic<uint64_t> encryptNanos{0}; ///< Encrypting
+    std::atomic<uint64_t> compareNanos{0}; ///< Comparing differences (and histogram updates)
+
+    /**
+     * @brief Add the work of one task
+     */
+    void addTask(uint64_t taskTrials, uint64_t taskHits, uint64_t rng, uint64_t encrypt, uint64_t compare)
+    {
+        add(trials, taskTrials);
+        add(hits, taskHits);
+        add(rngNanos, rng);
+        add(encryptNanos, encrypt);
+        add(compareNanos, compare);
+    }
+
+private:
+    // Single writer, so a relaxed load and store replace a locked read-modify-write
+    static void add(std::atomic<uint64_t>& counter, uint64_t value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief Per-worker counters, per-key progress and the reporter thread
+ */
+class Telemetry {
+public:
+    /**
+     * @param workers Number of workers, indexed like parallelFor()'s worker argument
+     * @param firstKey First key index the run covers
+     * @param lastKey One past the last key index
+     */
+    Telemetry(unsigned workers, size_t firstKey, size_t lastKey)
+        : workers_(allocateWorkers(workers), WorkerDeleter{workers}), numWorkers_(workers), firstKey_(firstKey),
+          keyTrials_(new std::atomic<uint64_t>[lastKey - firstKey]), numKeys_(lastKey - firstKey),
+          planned_(0), keyTarget_(0), stopping_(false), started_(false)
+    {
+        for (size_t k = 0; k < numKeys_; ++k) {
+            keyTrials_[k].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    ~Telemetry() { stop(); }
+
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+
+    WorkerTelemetry& worker(unsigned w) { return workers_[w]; }
+
+    /**
+     * @brief Record n more pairs counted for a key; any thread may call it
+     */
+    void addKeyTrials(size_t key, uint64_t n) { keyTrials_[key - firstKey_].fetch_add(n, std::memory_order_relaxed); }
+
+    /**
+     * @brief Queue more work: trials pairs in all, bringing every key to perKey pairs
+     *
+     * The ETA covers the work queued so far, so in adaptive mode it is the
+     * time to the end of the current batch.
+     */
+    void plan(uint64_t trials, uint64_t perKey)
+    {
+        planned_.fetch_add(trials, std::memory_order_relaxed);
+        keyTarget_.store(perKey, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Start reporting every intervalSeconds
+     *
+     * @param log Stream for the report lines, null for none
+     * @param exportPath JSON file rewritten at every report, empty for none
+     */
+    void start(double intervalSeconds, std::ostream* log, const std::string& exportPath)
+    {
+        interval_ = std::chrono::duration<double>(intervalSeconds);
+        log_ = log;
+        exportPath_ = exportPath;
+        start_ = last_ = std::chrono::steady_clock::now();
+        started_ = true;
+        thread_ = std::thread([this]() { run(); });
+    }
+
+    /**
+     * @brief Stop the reporter after a final report; safe to call more than once
+     */
+    void stop()
+    {
+        if (!started_) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        thread_.join();
+        started_ = false;
+        report(true);
+    }
+
+private:
+    // Before C++17 operator new[] ignores alignas(64), so the blocks are placed in storage aligned by hand
+    struct WorkerDeleter {
+        unsigned count;
+
+        void operator()(WorkerTelemetry* workers) const
+        {
+            for (unsigned w = 0; w < count; ++w) {
+                workers[w].~WorkerTelemetry();
+            }
+            std::free(workers);
+        }
+    };
+
+    static WorkerTelemetry* allocateWorkers(unsigned count)
+    {
+        void* storage = nullptr;
+        const size_t bytes = sizeof(WorkerTelemetry) * (count == 0 ? 1 : count);
+        if (posix_memalign(&storage, alignof(WorkerTelemetry), bytes) != 0) {
+            throw std::bad_alloc();
+        }
+        WorkerTelemetry* workers = static_cast<WorkerTelemetry*>(storage);
+        for (unsigned w = 0; w < count; ++w) {
+            new (&workers[w]) WorkerTelemetry();
+        }
+        return workers;
+    }
+
+    struct Totals {
+        uint64_t trials = 0;
+        uint64_t hits = 0;
+        uint64_t rngNanos = 0;
+        uint64_t encryptNanos = 0;
+        uint64_t compareNanos = 0;
+    };
+
+    Totals totals() const
+    {
+        Totals t;
+        for (unsigned w = 0; w < numWorkers_; ++w) {
+            t.trials += workers_[w].trials.load(std::memory_order_relaxed);
+            t.hits += workers_[w].hits.load(std::memory_order_relaxed);
+            t.rngNanos += workers_[w].rngNanos.load(std::memory_order_relaxed);
+            t.encryptNanos += workers_[w].encryptNanos.load(std::memory_order_relaxed);
+            t.compareNanos += workers_[w].compareNanos.load(std::memory_order_relaxed);
+        }
+        return t;
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!wake_.wait_for(lock, interval_, [this]() { return stopping_; })) {
+            lock.unlock();
+            report(false);
+            lock.lock();
+        }
+    }
+
+    static std::string clock(double seconds)
+    {
+        const long long s = static_cast<long long>(seconds + 0.5);
+        std::ostringstream out;
+        out << std::setfill('0') << s / 3600 << ":" << std::setw(2) << s / 60 % 60 << ":" << std::setw(2) << s % 60;
+        return out.str();
+    }
+
+    void report(bool final)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        const double elapsed = std::chrono::duration<double>(now - start_).count();
+        const double since = std::chrono::duration<double>(now - last_).count();
+        const Totals t = totals();
+        const uint64_t planned = planned_.load(std::memory_order_relaxed);
+        const uint64_t target = keyTarget_.load(std::memory_order_relaxed);
+        const double rate = elapsed > 0.0 ? t.trials / elapsed : 0.0;
+        const double current = since > 0.0 ? (t.trials - lastTrials_) / since : 0.0;
+        const double eta = rate > 0.0 && planned > t.trials ? (planned - t.trials) / rate : 0.0;
+        const double phases = static_cast<double>(t.rngNanos + t.encryptNanos + t.compareNanos);
+        last_ = now;
+        lastTrials_ = t.trials;
+
+        size_t keysDone = 0;
+        std::vector<std::pair<size_t, uint64_t>> running;
+        std::vector<uint64_t> keyTrials(numKeys_);
+        for (size_t k = 0; k < numKeys_; ++k) {
+            keyTrials[k] = keyTrials_[k].load(std::memory_order_relaxed);
+            if (target > 0 && keyTrials[k] >= target) {
+                ++keysDone;
+            } else if (keyTrials[k] > 0) {
+                running.push_back({firstKey_ + k, keyTrials[k]});
+            }
+        }
+
+        if (log_) {
+            std::ostringstream line;
+            line << "[telemetry " << clock(elapsed) << (final ? " final" : "") << "] " << std::setprecision(3)
+                 << static_cast<double>(t.trials) << " / " << static_cast<double>(planned) << " pairs";
+            if (planned > 0) {
+                line << " (" << std::fixed << std::setprecision(1) << 100.0 * t.trials / planned << "%)";
+            }
+            line << std::fixed << std::setprecision(2) << ", " << rate / 1e6 << " M pairs/s";
+            if (!final) {
+                line << " (now " << current / 1e6 << ")" << ", ETA " << clock(eta);
+            }
+            line << ", " << t.hits << " hits";
+            if (phases > 0.0) {
+                line << std::setprecision(0) << " | rng " << 100.0 * t.rngNanos / phases << "% encrypt "
+                     << 100.0 * t.encryptNanos / phases << "% compare " << 100.0 * t.compareNanos / phases << "%";
+            }
+            line << " | keys " << keysDone << "/" << numKeys_ << " done";
+            // A few of the keys in progress; all of them are in the JSON export
+            const size_t shown = std::min<size_t>(running.size(), 4);
+            for (size_t i = 0; i < shown; ++i) {
+                line << (i ? ", " : ", running ") << running[i].first;
+                if (target > 0) {
+                    line << " " << std::setprecision(0) << 100.0 * running[i].second / target << "%";
+                }
+            }
+            if (running.size() > shown) {
+                line << ", ...";
+            }
+            *log_ << line.str() << std::endl;
+        }
+
+        if (!exportPath_.empty()) {
+            std::ostringstream json;
+            json << "{\"elapsed_s\": " << elapsed << ", \"final\": " << (final ? "true" : "false")
+                 << ", \"trials\": " << t.trials << ", \"planned\": " << planned << ", \"hits\": " << t.hits
+                 << ", \"pairs_per_s\": " << rate << ", \"eta_s\": " << eta << ", \"rng_ns\": " << t.rngNanos
+                 << ", \"encrypt_ns\": " << t.encryptNanos << ", \"compare_ns\": " << t.compareNanos
+                 << ", \"workers\": [";
+            for (unsigned w = 0; w < numWorkers_; ++w) {
+                json << (w ? ", " : "") << workers_[w].trials.load(std::memory_order_relaxed);
+            }
+            json << "], \"first_key\": " << firstKey_ << ", \"key_target\": " << target << ", \"key_trials\": [";
+            for (size_t k = 0; k < numKeys_; ++k) {
+                json << (k ? ", " : "") << keyTrials[k];
+            }
+            json << "]}\n";
+            // Replaced in one rename, so a reader never sees half a snapshot
+            const std::string tmp = exportPath_ + ".tmp";
+            {
+                std::ofstream file(tmp, std::ios::trunc);
+                file << json.str();
+            }
+            if (std::rename(tmp.c_str(), exportPath_.c_str()) != 0 && log_) {
+                *log_ << "[telemetry] cannot write " << exportPath_ << std::endl;
+            }
+        }
+    }
+
+    std::unique_ptr<WorkerTelemetry[], WorkerDeleter> workers_;
+    unsigned numWorkers_;
+    size_t firstKey_;
+    std::unique_ptr<std::atomic<uint64_t>[]> keyTrials_; ///< Pairs counted per key, including resumed ones
+    size_t numKeys_;
+    std::atomic<uint64_t> planned_;   ///< Pairs queued so far
+    std::atomic<uint64_t> keyTarget_; ///< Pairs a key needs to be done
+
+    std::chrono::duration<double> interval_{0.0};
+    std::ostream* log_ = nullptr;
+    std::string exportPath_;
+    std::chrono::steady_clock::time_point start_, last_;
+    uint64_t lastTrials_ = 0;
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_;
+    bool started_;
+};
+
+#endif /* D46FEEC4_CA58_48F6_B8C7_7C2BA2233294 */
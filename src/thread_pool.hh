@@ -0,0 +1,132 @@
+/*
+ * File: thread_pool.hh
+ *
+ * Description:    Work-stealing parallel loop for the experiment executables
+ *
+ * parallelFor() splits a range of independent tasks into one contiguous block
+ * per worker. A worker takes tasks from the front of its own block, and once
+ * that is empty it steals the back half of the largest remaining block, so
+ * uneven tasks and uneven cores still finish together. Tasks are meant to be
+ * coarse (thousands of encryptions each), so every block is guarded by a plain
+ * mutex.
+ *
+ * Copyright (c) 2025 Ahmet Çobanoğlu
+ * All rights reserved.
+ *
+ * This file is proprietary and confidential. Unauthorized copying, distribution,
+ * modification, or use of this file, via any medium, is strictly prohibited
+ * without express written permission from the copyright holder.
+ */
+
+#ifndef C3665A26_A34D_4759_95D8_46831939ABAF
+#define C3665A26_A34D_4759_95D8_46831939ABAF
+
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Number of worker threads to use by default
+ */
+inline unsigned defaultThreadCount()
+{
+    unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+/**
+ * @brief Run fn(task, worker) for every task in [0, numTasks) on numThreads workers
+ *
+ * Which worker runs which task depends on timing. Results must therefore be
+ * accumulated per worker (indexed by the worker argument) and reduced after
+ * parallelFor() returns, and a task must not depend on the worker that runs it.
+ *
+ * @param numTasks Number of tasks
+ * @param numThreads Number of worker threads (the calling thread is worker 0)
+ * @param fn Callable taking (size_t task, unsigned worker)
+ */
+template <typename Fn>
+void parallelFor(size_t numTasks, unsigned numThreads, Fn fn)
+{
+    if (numThreads == 0) {
+        numThreads = 1;
+    }
+    if (numThreads > numTasks) {
+        numThreads = numTasks == 0 ? 1 : static_cast<unsigned>(numTasks);
+    }
+
+    struct Block {
+        std::mutex lock;
+        size_t begin;
+        size_t end;
+    };
+    std::vector<Block> blocks(numThreads);
+    for (unsigned w = 0; w < numThreads; ++w) {
+        blocks[w].begin = numTasks * w / numThreads;
+        blocks[w].end = numTasks * (w + 1) / numThreads;
+    }
+
+    auto worker = [&blocks, &fn, numThreads](unsigned self) {
+        for (;;) {
+            size_t task = 0;
+            bool found = false;
+            {
+                std::lock_guard<std::mutex> guard(blocks[self].lock);
+                if (blocks[self].begin < blocks[self].end) {
+                    task = blocks[self].begin++;
+                    found = true;
+                }
+            }
+
+            if (!found) {
+                // Steal the back half of the largest remaining block
+                unsigned victim = self;
+                size_t largest = 0;
+                for (unsigned w = 0; w < numThreads; ++w) {
+                    std::lock_guard<std::mutex> guard(blocks[w].lock);
+                    size_t remaining = blocks[w].end - blocks[w].begin;
+                    if (remaining > largest) {
+                        largest = remaining;
+                        victim = w;
+                    }
+                }
+                if (largest == 0) {
+                    return;
+                }
+
+                size_t stolenBegin = 0;
+                size_t stolenEnd = 0;
+                {
+                    std::lock_guard<std::mutex> guard(blocks[victim].lock);
+                    size_t remaining = blocks[victim].end - blocks[victim].begin;
+                    if (remaining == 0) {
+                        continue; // Someone else got there first
+                    }
+                    stolenEnd = blocks[victim].end;
+                    stolenBegin = stolenEnd - (remaining + 1) / 2;
+                    blocks[victim].end = stolenBegin;
+                }
+                {
+                    std::lock_guard<std::mutex> guard(blocks[self].lock);
+                    blocks[self].begin = stolenBegin;
+                    blocks[self].end = stolenEnd;
+                }
+                continue;
+            }
+
+            fn(task, self);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned w = 1; w < numThreads; ++w) {
+        threads.emplace_back(worker, w);
+    }
+    worker(0);
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+#endif /* C3665A26_A34D_4759_95D8_46831939ABAF */
@@ -0,0 +1,423 @@
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+#include "present.hh"
+#include "present_core.hh"
+#include "sbox_tables.hh"
+#include "nibble_activity.hh"
+#include "hex_format.hh"
+#include "thread_pool.hh"
+
+// Matsui-style branch-and-bound search for differential trails of PRESENT.
+//
+// A trail is the sequence of differences diff[0] .. diff[r] between the
+// rounds (diff[0] is the input difference alpha, diff[r] the difference after
+// the r-th pLayer, beta). Its weight is the sum of the S-box weights
+// -log2(DDT[a][b] / 16) over all active S-boxes, so its probability is 2^-weight.
+//
+// The search assigns the active S-boxes of a round one at a time, lightest
+// transition first, and prunes as soon as
+//   weight so far + (minimum weight) * (active S-boxes left in the round)
+//                 + B[rounds left after this one]  >  bound
+// where B[k] is the best k-round weight, found beforehand by running the
+// same search with increasing bounds. Once all S-boxes of a round are set,
+// the next difference is the pLayer of the whole 64-bit output word.
+//
+// The first round is searched by its S-box output, each active S-box counted
+// at the weight of its lightest input, so the subtree below a first-round
+// output is explored once for all the alphas leading to it. The alphas are
+// expanded only when a trail is reported. The tasks handed to the worker
+// threads are the first-round branches: the lowest active S-box and its
+// output difference.
+
+const int MAX_ROUNDS = 31;
+
+struct Transition {
+    uint64_t in;
+    uint64_t out;
+    int weight;
+};
+
+// Non-zero transitions by input and by output difference, lightest first
+struct TransitionLists {
+    std::vector<Transition> byInput[16];
+    std::vector<Transition> byOutput[16];
+    std::vector<Transition> outputs; // Lightest transition to each output difference
+    int minWeight;
+};
+
+TransitionLists buildTransitions() {
+    TransitionLists lists;
+    lists.minWeight = 4;
+    for (int a = 1; a < 16; ++a) {
+        for (int b = 1; b < 16; ++b) {
+            const int count = DDT.entry[a][b];
+            if (count == 0) {
+                continue;
+            }
+            const int weight = differenceWeight(count);
+            if (weight < 0) {
+                throw std::runtime_error("DDT entry is not a power of two; integer weights are required.");
+            }
+            Transition t = {static_cast<uint64_t>(a), static_cast<uint64_t>(b), weight};
+            lists.byInput[a].push_back(t);
+            lists.byOutput[b].push_back(t);
+            lists.minWeight = std::min(lists.minWeight, weight);
+        }
+    }
+    auto lighter = [](const Transition& x, const Transition& y) {
+        return x.weight != y.weight ? x.weight < y.weight : (x.in != y.in ? x.in < y.in : x.out < y.out);
+    };
+    for (int d = 1; d < 16; ++d) {
+        std::sort(lists.byInput[d].begin(), lists.byInput[d].end(), lighter);
+        std::sort(lists.byOutput[d].begin(), lists.byOutput[d].end(), lighter);
+        lists.outputs.push_back(lists.byOutput[d].front());
+    }
+    std::sort(lists.outputs.begin(), lists.outputs.end(), lighter);
+    return lists;
+}
+
+struct Trail {
+    int weight;
+    uint64_t diff[MAX_ROUNDS + 1];
+};
+
+// Trail under construction: diff[0] is only filled in when alphas are expanded
+struct Path {
+    uint64_t diff[MAX_ROUNDS + 1];
+    uint64_t firstOut; // S-box output difference of the first round
+    int firstWeight;   // First-round weight with the lightest input per S-box
+};
+
+struct PairStats {
+    uint64_t trails;    // Trails found from alpha to beta
+    int bestWeight;     // Lightest of them
+    double probability; // Sum of their probabilities
+};
+
+struct PairHash {
+    size_t operator()(const std::pair<uint64_t, uint64_t>& p) const {
+        return std::hash<uint64_t>()(p.first * 0x9E3779B97F4A7C15ULL ^ p.second);
+    }
+};
+
+typedef std::unordered_map<std::pair<uint64_t, uint64_t>, PairStats, PairHash> PairMap;
+
+// Per-thread results, merged after the search
+struct WorkerResult {
+    bool haveBest = false;
+    Trail best;
+    uint64_t trails = 0;
+    PairMap pairs;
+};
+
+struct Search {
+    const TransitionLists& transitions;
+    int rounds;
+    const std::vector<int>& lowerBound; // lowerBound[k]: best weight over k rounds
+    int bound;                          // Trails of weight <= bound are reported
+    bool collect;                       // false: stop at the first trail found
+    uint64_t maxTrails;
+    std::atomic<bool> stop;
+    std::atomic<uint64_t> found;
+
+    Search(const TransitionLists& t, int r, const std::vector<int>& lb, int b, bool c, uint64_t m)
+        : transitions(t), rounds(r), lowerBound(lb), bound(b), collect(c), maxTrails(m), stop(false), found(0) {}
+};
+
+bool lighterTrail(const uint64_t* diff, int weight, const Trail& other, int rounds) {
+    if (weight != other.weight) {
+        return weight < other.weight;
+    }
+    return std::lexicographical_compare(diff, diff + rounds + 1, other.diff, other.diff + rounds + 1);
+}
+
+void reportTrail(Search& s, WorkerResult& res, const uint64_t* diff, int weight) {
+    ++res.trails;
+    if (!res.haveBest || lighterTrail(diff, weight, res.best, s.rounds)) {
+        res.haveBest = true;
+        res.best.weight = weight;
+        std::copy(diff, diff + s.rounds + 1, res.best.diff);
+    }
+    if (!s.collect) {
+        s.stop.store(true, std::memory_order_relaxed);
+        return;
+    }
+
+    PairStats& stats = res.pairs[std::make_pair(diff[0], diff[s.rounds])];
+    if (stats.trails == 0 || weight < stats.bestWeight) {
+        stats.bestWeight = weight;
+    }
+    ++stats.trails;
+    stats.probability += std::ldexp(1.0, -weight);
+    if (s.found.fetch_add(1, std::memory_order_relaxed) + 1 >= s.maxTrails) {
+        s.stop.store(true, std::memory_order_relaxed);
+    }
+}
+
+// Report every alpha that reaches the first-round output within the bound.
+// pending holds the first-round S-boxes still to be given an input; weight
+// counts the ones already given one at their actual weight and the pending
+// ones at their lightest.
+void expandAlphas(Search& s, WorkerResult& res, Path& path, uint64_t pending, uint64_t alpha, int weight) {
+    if (s.stop.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (pending == 0) {
+        path.diff[0] = alpha;
+        reportTrail(s, res, path.diff, weight);
+        return;
+    }
+
+    const int bit = __builtin_ctzll(pending);
+    pending &= pending - 1;
+    const std::vector<Transition>& inputs = s.transitions.byOutput[(path.firstOut >> bit) & 0xF];
+    const int lightest = inputs.front().weight;
+    for (const Transition& t : inputs) {
+        if (weight - lightest + t.weight > s.bound) {
+            break;
+        }
+        expandAlphas(s, res, path, pending, alpha | (t.in << bit), weight - lightest + t.weight);
+    }
+}
+
+void searchRound(Search& s, WorkerResult& res, Path& path, int round,
+                 uint64_t pending, uint64_t sboxOut, int weight);
+
+// All S-boxes of the round are assigned: apply the pLayer and go on
+void finishRound(Search& s, WorkerResult& res, Path& path, int round, uint64_t sboxOut, int weight) {
+    path.diff[round + 1] = present_detail::pLayerShift(sboxOut);
+    if (round + 1 == s.rounds) {
+        expandAlphas(s, res, path, activeMask(path.firstOut), 0, weight);
+        return;
+    }
+    searchRound(s, res, path, round + 1, activeMask(path.diff[round + 1]), 0, weight);
+}
+
+// Rounds after the first: the input difference is fixed, pending holds the
+// active S-boxes whose output difference is still to be chosen
+void searchRound(Search& s, WorkerResult& res, Path& path, int round,
+                 uint64_t pending, uint64_t sboxOut, int weight) {
+    if (s.stop.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (pending == 0) {
+        finishRound(s, res, path, round, sboxOut, weight);
+        return;
+    }
+
+    const int bit = __builtin_ctzll(pending);
+    pending &= pending - 1;
+    const int limit = s.bound - s.lowerBound[s.rounds - round - 1]
+                      - s.transitions.minWeight * __builtin_popcountll(pending);
+    for (const Transition& t : s.transitions.byInput[(path.diff[round] >> bit) & 0xF]) {
+        if (weight + t.weight > limit) {
+            break;
+        }
+        searchRound(s, res, path, round, pending, sboxOut | (t.out << bit), weight + t.weight);
+    }
+}
+
+// First round: active S-boxes are added in increasing position from nibble
+// next on, by output difference; every prefix is also tried as complete.
+void searchFirstRound(Search& s, WorkerResult& res, Path& path, int next, uint64_t sboxOut, int weight) {
+    if (s.stop.load(std::memory_order_relaxed)) {
+        return;
+    }
+    path.firstOut = sboxOut;
+    path.firstWeight = weight;
+    finishRound(s, res, path, 0, sboxOut, weight);
+
+    const int limit = s.bound - s.lowerBound[s.rounds - 1];
+    for (int nibble = next; nibble < 16; ++nibble) {
+        for (const Transition& t : s.transitions.outputs) {
+            if (weight + t.weight > limit) {
+                break;
+            }
+            searchFirstRound(s, res, path, nibble + 1, sboxOut | (t.out << (4 * nibble)), weight + t.weight);
+        }
+    }
+}
+
+// Run the search over all first-round branches; returns the per-thread results
+std::vector<WorkerResult> runSearch(Search& s, unsigned numThreads) {
+    const std::vector<Transition>& outputs = s.transitions.outputs;
+    std::vector<WorkerResult> results(numThreads);
+    parallelFor(16 * outputs.size(), numThreads, [&](size_t task, unsigned w) {
+        const int nibble = static_cast<int>(task / outputs.size());
+        const Transition& t = outputs[task % outputs.size()];
+        if (t.weight + s.lowerBound[s.rounds - 1] > s.bound) {
+            return;
+        }
+        Path path;
+        searchFirstRound(s, results[w], path, nibble + 1, t.out << (4 * nibble), t.weight);
+    });
+    return results;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--rounds <r>] [--slack <w>] [--top <K>] [--threads <n>]"
+              << " [--max-trails <n>] [--ddt] [--emit-args]" << std::endl;
+    std::cerr << "  --emit-args prints only \"--alpha <a> --beta <b>\" for the best pair, e.g." << std::endl;
+    std::cerr << "  ./differential_experiment $(./trail_search --emit-args)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+
+    int rounds = 4;            // Rounds of the differential experiment
+    int slack = 2;             // Collect trails up to this much heavier than the best
+    size_t top_k = 10;
+    unsigned num_threads = defaultThreadCount();
+    uint64_t max_trails = 1ULL << 24;
+    bool print_ddt = false;
+    bool emit_args = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--ddt") {
+            print_ddt = true;
+        } else if (arg == "--emit-args") {
+            emit_args = true;
+        } else if ((arg == "--rounds" || arg == "--slack" || arg == "--top" || arg == "--threads" ||
+                    arg == "--max-trails") && i + 1 < argc) {
+            std::string value = argv[++i];
+            unsigned long long number = 0;
+            try {
+                number = std::stoull(value, nullptr, 0);
+            } catch (const std::exception&) {
+                std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+                return 1;
+            }
+            if (arg == "--rounds") {
+                if (number < 1 || number > MAX_ROUNDS) {
+                    std::cerr << "--rounds must be between 1 and " << MAX_ROUNDS << std::endl;
+                    return 1;
+                }
+                rounds = static_cast<int>(number);
+            } else if (arg == "--slack") {
+                slack = static_cast<int>(std::min(number, 64ULL));
+            } else if (arg == "--top") {
+                top_k = static_cast<size_t>(number);
+            } else if (arg == "--threads") {
+                num_threads = number == 0 ? defaultThreadCount() : static_cast<unsigned>(number);
+            } else {
+                max_trails = std::max(number, 1ULL);
+            }
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    const TransitionLists transitions = buildTransitions();
+    std::ostream& log = emit_args ? std::cerr : std::cout;
+    auto start = std::chrono::steady_clock::now();
+
+    if (print_ddt) {
+        log << "Difference distribution table of the PRESENT S-box (rows: input, columns: output):" << std::endl;
+        for (int a = 0; a < 16; ++a) {
+            log << "  " << std::hex << std::uppercase << a << std::dec << ":";
+            for (int b = 0; b < 16; ++b) {
+                log << std::setw(3) << std::setfill(' ') << DDT.entry[a][b];
+            }
+            log << std::endl;
+        }
+        log << std::nouppercase;
+    }
+
+    // Best weights B[1] .. B[rounds], each by increasing the bound from B[k-1]
+    // plus one active S-box until the search finds a trail
+    std::vector<int> best_weight(rounds + 1, 0);
+    log << "Best trail weights:" << std::endl;
+    for (int k = 1; k <= rounds; ++k) {
+        for (int bound = best_weight[k - 1] + transitions.minWeight;; ++bound) {
+            Search s(transitions, k, best_weight, bound, false, 1);
+            std::vector<WorkerResult> results = runSearch(s, num_threads);
+            if (s.stop.load()) {
+                best_weight[k] = bound;
+                break;
+            }
+        }
+        log << "  B[" << std::setw(2) << std::setfill(' ') << k << "] = " << best_weight[k]
+            << "  (P = 2^-" << best_weight[k] << ")" << std::endl;
+    }
+
+    // All trails within the slack of the best, grouped by (alpha, beta)
+    Search s(transitions, rounds, best_weight, best_weight[rounds] + slack, true, max_trails);
+    std::vector<WorkerResult> results = runSearch(s, num_threads);
+    const bool truncated = s.found.load() >= max_trails;
+
+    Trail best = Trail();
+    bool have_best = false;
+    uint64_t total_trails = 0;
+    PairMap pairs;
+    for (const WorkerResult& res : results) {
+        total_trails += res.trails;
+        if (res.haveBest && (!have_best || lighterTrail(res.best.diff, res.best.weight, best, rounds))) {
+            best = res.best;
+            have_best = true;
+        }
+        for (const auto& entry : res.pairs) {
+            PairStats& stats = pairs[entry.first];
+            if (stats.trails == 0 || entry.second.bestWeight < stats.bestWeight) {
+                stats.bestWeight = entry.second.bestWeight;
+            }
+            stats.trails += entry.second.trails;
+            stats.probability += entry.second.probability;
+        }
+    }
+
+    // Rank by the summed probability of the trails found, which is a lower
+    // bound on the probability of the differential
+    std::vector<std::pair<std::pair<uint64_t, uint64_t>, PairStats>> ranked(pairs.begin(), pairs.end());
+    std::sort(ranked.begin(), ranked.end(), [](const std::pair<std::pair<uint64_t, uint64_t>, PairStats>& a,
+                                               const std::pair<std::pair<uint64_t, uint64_t>, PairStats>& b) {
+        if (a.second.probability != b.second.probability) {
+            return a.second.probability > b.second.probability;
+        }
+        return a.first < b.first;
+    });
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    log << "--------------------------------------------------" << std::endl;
+    log << "Trails of " << rounds << " rounds with weight <= " << best_weight[rounds] + slack << ": "
+        << total_trails << " over " << ranked.size() << " (alpha, beta) pairs"
+        << (truncated ? " (stopped at --max-trails, ranking incomplete)" : "") << std::endl;
+    if (have_best) {
+        log << "Best trail (weight " << best.weight << "):" << std::endl;
+        for (int r = 0; r <= rounds; ++r) {
+            log << "  after round " << r << ": " << hex64(best.diff[r]) << std::endl;
+        }
+    }
+    log << "Top (alpha, beta) pairs by summed trail probability:" << std::endl;
+    for (size_t i = 0; i < std::min(top_k, ranked.size()); ++i) {
+        const PairStats& stats = ranked[i].second;
+        log << "  alpha " << hex64(ranked[i].first.first) << "  beta " << hex64(ranked[i].first.second)
+            << "  trails " << std::setw(6) << std::setfill(' ') << stats.trails
+            << "  best 2^-" << std::setw(2) << stats.bestWeight
+            << "  sum 2^(-" << std::fixed << std::setprecision(2) << -std::log2(stats.probability) << ")"
+            << std::defaultfloat << std::endl;
+    }
+    log << "Search time: " << std::fixed << std::setprecision(3) << elapsed.count() << " s on "
+        << num_threads << " thread(s)" << std::defaultfloat << std::endl;
+
+    if (emit_args) {
+        if (ranked.empty()) {
+            return 1;
+        }
+        std::cout << "--alpha " << hex64(ranked[0].first.first) << " --beta " << hex64(ranked[0].first.second)
+                  << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,536 @@
+#include "present.hh"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // For __rdtsc
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Benchmark suite for the PRESENT engines, written as JSON for tracking
+// regressions between releases.
+//
+// Every case is run once to warm up, calibrated so that one repetition takes
+// at least --min-time-ms, and then repeated --repetitions times. The median,
+// mean, standard deviation, minimum and maximum over the repetitions are
+// reported in cycles and nanoseconds per block (or per call). Cycles come
+// from the CPU cycle counter through perf_event_open when the kernel allows
+// it, and from the time-stamp counter (reference cycles) otherwise; the JSON
+// records which.
+//
+// Cases:
+//   encrypt        encryptBlocks() per engine, key size, round count and batch size
+//   encrypt_call   latency of chained Present::encrypt() calls
+//   set_key        cost of setKey() (the key schedule) per key size and round count
+//   threads        aggregate encryptBlocks() throughput of 1 .. N threads, one cipher each
+//
+// --quick runs a reduced set with few repetitions; ctest runs it as a smoke test.
+
+namespace {
+
+struct Options {
+    bool quick = false;
+    int repetitions = 11;
+    double minTimeMs = 20.0;
+    unsigned maxThreads = 0; // 0: hardware concurrency
+    std::string filter;      // Only cases whose name contains this
+    std::string output;      // JSON file, stdout if empty
+};
+
+// CPU cycles of the calling thread, or the time-stamp counter as a fallback
+class CycleCounter {
+public:
+    CycleCounter() : fd_(-1)
+    {
+#ifdef __linux__
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        uint64_t probe = 0;
+        if (fd_ >= 0 && ::read(fd_, &probe, sizeof(probe)) != sizeof(probe)) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+#endif
+    }
+
+    ~CycleCounter()
+    {
+#ifdef __linux__
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+#endif
+    }
+
+    CycleCounter(const CycleCounter&) = delete;
+    CycleCounter& operator=(const CycleCounter&) = delete;
+
+    uint64_t read() const
+    {
+#ifdef __linux__
+        if (fd_ >= 0) {
+            uint64_t value = 0;
+            if (::read(fd_, &value, sizeof(value)) == sizeof(value)) {
+                return value;
+            }
+        }
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    const char* source() const
+    {
+        if (fd_ >= 0) {
+            return "perf_event";
+        }
+#if defined(__x86_64__) || defined(__i386__)
+        return "rdtsc";
+#else
+        return "none";
+#endif
+    }
+
+private:
+    int fd_;
+};
+
+struct Stats {
+    double median, mean, stddev, min, max;
+};
+
+Stats summarize(std::vector<double> values)
+{
+    Stats s{0.0, 0.0, 0.0, 0.0, 0.0};
+    if (values.empty()) {
+        return s;
+    }
+    std::sort(values.begin(), values.end());
+    const size_t n = values.size();
+    s.median = n % 2 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+    s.min = values.front();
+    s.max = values.back();
+    for (double v : values) {
+        s.mean += v;
+    }
+    s.mean /= n;
+    for (double v : values) {
+        s.stddev += (v - s.mean) * (v - s.mean);
+    }
+    s.stddev = n > 1 ? std::sqrt(s.stddev / (n - 1)) : 0.0;
+    return s;
+}
+
+std::string jsonStats(const Stats& s)
+{
+    std::ostringstream out;
+    out.precision(6);
+    out << "{\"median\": " << s.median << ", \"mean\": " << s.mean << ", \"stddev\": " << s.stddev
+        << ", \"min\": " << s.min << ", \"max\": " << s.max << "}";
+    return out.str();
+}
+
+std::string jsonString(const std::string& value)
+{
+    std::string out = "\"";
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out + "\"";
+}
+
+// Collects the JSON objects of the results
+class Report {
+public:
+    void add(const std::string& fields) { results_.push_back("{" + fields + "}"); }
+
+    std::string json(const std::string& context) const
+    {
+        std::string out = "{\n  \"benchmark\": \"present\",\n  \"format\": 1,\n  \"context\": " + context +
+                          ",\n  \"results\": [";
+        for (size_t i = 0; i < results_.size(); ++i) {
+            out += (i ? ",\n    " : "\n    ") + results_[i];
+        }
+        return out + "\n  ]\n}\n";
+    }
+
+private:
+    std::vector<std::string> results_;
+};
+
+// Runs op(iterations) --repetitions times after a warm-up and a calibration
+// of the iteration count. Returns cycles and nanoseconds per unit, where one
+// iteration is unitsPerIteration units.
+template <typename Op>
+void measure(const Options& options, const CycleCounter& counter, double unitsPerIteration, Op op,
+             Stats& cycles, Stats& nanos, uint64_t& iterations)
+{
+    using Clock = std::chrono::steady_clock;
+    op(1);
+
+    iterations = 1;
+    for (;;) {
+        auto start = Clock::now();
+        op(iterations);
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (ms >= options.minTimeMs || iterations >= (1ULL << 40)) {
+            break;
+        }
+        // Aim a little past the target so the loop ends after one more try
+        const double scale = ms > 0.0 ? 1.2 * options.minTimeMs / ms : 16.0;
+        iterations = static_cast<uint64_t>(std::ceil(iterations * std::min(std::max(scale, 2.0), 16.0)));
+    }
+
+    std::vector<double> c, t;
+    for (int r = 0; r < options.repetitions; ++r) {
+        auto start = Clock::now();
+        const uint64_t c0 = counter.read();
+        op(iterations);
+        const uint64_t c1 = counter.read();
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        const double units = unitsPerIteration * iterations;
+        c.push_back((c1 - c0) / units);
+        t.push_back(ns / units);
+    }
+    cycles = summarize(c);
+    nanos = summarize(t);
+}
+
+struct EngineCase {
+    Present::Engine engine;
+    const char* name;
+};
+
+const EngineCase ENGINES[] = {
+    {Present::Engine::Scalar, "scalar"},
+    {Present::Engine::Table, "table"},
+    {Present::Engine::Simd, "simd"},
+    {Present::Engine::Bitsliced, "bitsliced"},
+    {Present::Engine::Auto, "auto"},
+};
+
+Present makeCipher(Present::KeySize keySize, int rounds)
+{
+    Present cipher(keySize, rounds);
+    std::mt19937_64 rng(0xBE4C4ULL);
+    std::vector<uint8_t> key(static_cast<size_t>(keySize) / 8);
+    for (auto& b : key) {
+        b = static_cast<uint8_t>(rng());
+    }
+    cipher.setKey(key.data(), key.size());
+    return cipher;
+}
+
+std::vector<uint64_t> makeBlocks(size_t n)
+{
+    std::mt19937_64 rng(0xB10C5ULL + n);
+    std::vector<uint64_t> blocks(n);
+    for (auto& b : blocks) {
+        b = rng();
+    }
+    return blocks;
+}
+
+bool selected(const Options& options, const std::string& name)
+{
+    return options.filter.empty() || name.find(options.filter) != std::string::npos;
+}
+
+std::string caseFields(const std::string& name, const char* kind, int keyBits, int rounds)
+{
+    return "\"name\": " + jsonString(name) + ", \"kind\": " + jsonString(kind) +
+           ", \"key_bits\": " + std::to_string(keyBits) + ", \"rounds\": " + std::to_string(rounds);
+}
+
+void benchEncrypt(const Options& options, const CycleCounter& counter, Report& report)
+{
+    const std::vector<size_t> batches = options.quick ? std::vector<size_t>{1, 1024}
+                                                      : std::vector<size_t>{1, 16, 64, 1024, 65536, 1 << 20};
+    const std::vector<Present::KeySize> keySizes = options.quick
+        ? std::vector<Present::KeySize>{Present::KeySize::KEY_80}
+        : std::vector<Present::KeySize>{Present::KeySize::KEY_80, Present::KeySize::KEY_128};
+
+    for (Present::KeySize keySize : keySizes) {
+        const int keyBits = static_cast<int>(keySize);
+        for (int rounds : {4, 31}) {
+            Present cipher = makeCipher(keySize, rounds);
+            for (const auto& e : ENGINES) {
+                for (size_t batch : batches) {
+                    const std::string name = "encrypt/" + std::string(e.name) + "/" + std::to_string(keyBits) +
+                                             "/" + std::to_string(rounds) + "/" + std::to_string(batch);
+                    if (!selected(options, name)) {
+                        continue;
+                    }
+                    std::vector<uint64_t> blocks = makeBlocks(batch);
+                    Stats cycles, nanos;
+                    uint64_t iterations = 0;
+                    // Encrypting in place keeps the working set at one buffer
+                    measure(options, counter, static_cast<double>(batch), [&](uint64_t n) {
+                        for (uint64_t i = 0; i < n; ++i) {
+                            cipher.encryptBlocks(blocks.data(), blocks.data(), batch, e.engine);
+                        }
+                    }, cycles, nanos, iterations);
+
+                    std::ostringstream fields;
+                    fields << caseFields(name, "encrypt", keyBits, rounds) << ", \"engine\": " << jsonString(e.name)
+                           << ", \"batch\": " << batch << ", \"iterations\": " << iterations
+                           << ", \"cycles_per_block\": " << jsonStats(cycles)
+                           << ", \"ns_per_block\": " << jsonStats(nanos)
+                           << ", \"mb_per_s\": " << 8.0 * 1e3 / nanos.median;
+                    report.add(fields.str());
+                    std::cerr << name << ": " << cycles.median << " cycles/block" << std::endl;
+                }
+            }
+        }
+    }
+}
+
+void benchEncryptCall(const Options& options, const CycleCounter& counter, Report& report)
+{
+    for (Present::KeySize keySize : {Present::KeySize::KEY_80, Present::KeySize::KEY_128}) {
+        const int keyBits = static_cast<int>(keySize);
+        for (int rounds : {4, 31}) {
+            const std::string name = "encrypt_call/" + std::to_string(keyBits) + "/" + std::to_string(rounds);
+            if (!selected(options, name) || (options.quick && keySize != Present::KeySize::KEY_80)) {
+                continue;
+            }
+            Present cipher = makeCipher(keySize, rounds);
+            uint64_t state = 0x0123456789ABCDEFULL;
+            Stats cycles, nanos;
+            uint64_t iterations = 0;
+            // Each call depends on the previous result, so this is latency
+            measure(options, counter, 1.0, [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) {
+                    state = cipher.encrypt(state);
+                }
+            }, cycles, nanos, iterations);
+            if (state == 0) {
+                std::cerr << "(zero state)" << std::endl;
+            }
+
+            std::ostringstream fields;
+            fields << caseFields(name, "encrypt_call", keyBits, rounds) << ", \"iterations\": " << iterations
+                   << ", \"cycles_per_block\": " << jsonStats(cycles) << ", \"ns_per_block\": " << jsonStats(nanos)
+                   << ", \"mb_per_s\": " << 8.0 * 1e3 / nanos.median;
+            report.add(fields.str());
+            std::cerr << name << ": " << cycles.median << " cycles/call" << std::endl;
+        }
+    }
+}
+
+void benchSetKey(const Options& options, const CycleCounter& counter, Report& report)
+{
+    for (Present::KeySize keySize : {Present::KeySize::KEY_80, Present::KeySize::KEY_128}) {
+        const int keyBits = static_cast<int>(keySize);
+        for (int rounds : {4, 31}) {
+            const std::string name = "set_key/" + std::to_string(keyBits) + "/" + std::to_string(rounds);
+            if (!selected(options, name)) {
+                continue;
+            }
+            Present cipher(keySize, rounds);
+            std::vector<uint8_t> key(static_cast<size_t>(keySize) / 8, 0x5A);
+            Stats cycles, nanos;
+            uint64_t iterations = 0;
+            measure(options, counter, 1.0, [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) {
+                    key[0] = static_cast<uint8_t>(i);
+                    cipher.setKey(key.data(), key.size());
+                }
+            }, cycles, nanos, iterations);
+
+            std::ostringstream fields;
+            fields << caseFields(name, "set_key", keyBits, rounds) << ", \"iterations\": " << iterations
+                   << ", \"cycles_per_call\": " << jsonStats(cycles) << ", \"ns_per_call\": " << jsonStats(nanos);
+            report.add(fields.str());
+            std::cerr << name << ": " << cycles.median << " cycles/call" << std::endl;
+        }
+    }
+}
+
+// Every thread encrypts its own buffer with its own cipher; the threads start
+// together and the slowest one sets the time of a repetition
+void benchThreads(const Options& options, Report& report)
+{
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    const unsigned maxThreads = options.maxThreads ? options.maxThreads : hardware;
+    std::vector<unsigned> counts;
+    for (unsigned t = 1; t < maxThreads; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(maxThreads);
+
+    const size_t batch = 4096;
+    const int rounds = 31;
+    double single = 0.0;
+    for (unsigned threads : counts) {
+        const std::string name = "threads/auto/80/31/" + std::to_string(threads);
+        if (!selected(options, name)) {
+            continue;
+        }
+        std::vector<Present> ciphers;
+        std::vector<std::vector<uint64_t>> buffers;
+        for (unsigned t = 0; t < threads; ++t) {
+            ciphers.push_back(makeCipher(Present::KeySize::KEY_80, rounds));
+            buffers.push_back(makeBlocks(batch));
+        }
+
+        auto run = [&](uint64_t n) {
+            std::atomic<unsigned> ready(0);
+            std::vector<std::thread> pool;
+            for (unsigned t = 0; t < threads; ++t) {
+                pool.emplace_back([&, t]() {
+                    ready.fetch_add(1);
+                    while (ready.load() < threads) {
+                        std::this_thread::yield();
+                    }
+                    for (uint64_t i = 0; i < n; ++i) {
+                        ciphers[t].encryptBlocks(buffers[t].data(), buffers[t].data(), batch);
+                    }
+                });
+            }
+            for (auto& th : pool) {
+                th.join();
+            }
+        };
+
+        CycleCounter unused;
+        Stats cycles, nanos;
+        uint64_t iterations = 0;
+        // Time per block of all threads together: the aggregate throughput
+        measure(options, unused, static_cast<double>(batch) * threads, run, cycles, nanos, iterations);
+        if (threads == 1) {
+            single = nanos.median;
+        }
+
+        std::ostringstream fields;
+        fields << caseFields(name, "threads", 80, rounds) << ", \"engine\": \"auto\", \"batch\": " << batch
+               << ", \"threads\": " << threads << ", \"iterations\": " << iterations
+               << ", \"ns_per_block\": " << jsonStats(nanos) << ", \"mb_per_s\": " << 8.0 * 1e3 / nanos.median;
+        if (single > 0.0) {
+            fields << ", \"speedup\": " << single / nanos.median;
+        }
+        report.add(fields.str());
+        std::cerr << name << ": " << 8.0 * 1e3 / nanos.median << " MB/s" << std::endl;
+    }
+}
+
+void printUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [--quick] [--repetitions <r>] [--min-time-ms <t>] [--threads <n>]"
+              << " [--filter <text>] [--output <file.json>]" << std::endl;
+    std::cerr << "  Writes the results as JSON to stdout or --output; progress goes to stderr." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    bool repetitionsSet = false;
+    bool minTimeSet = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--quick") {
+            options.quick = true;
+        } else if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if ((arg == "--repetitions" || arg == "--min-time-ms" || arg == "--threads") && i + 1 < argc) {
+            std::string value = argv[++i];
+            double number = 0.0;
+            try {
+                number = std::stod(value);
+            } catch (const std::exception&) {
+                number = 0.0;
+            }
+            if (!(number > 0.0)) {
+                std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+                return 1;
+            }
+            if (arg == "--repetitions") {
+                options.repetitions = static_cast<int>(number);
+                repetitionsSet = true;
+            } else if (arg == "--min-time-ms") {
+                options.minTimeMs = number;
+                minTimeSet = true;
+            } else {
+                options.maxThreads = static_cast<unsigned>(number);
+            }
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.quick) {
+        options.repetitions = repetitionsSet ? options.repetitions : 3;
+        options.minTimeMs = minTimeSet ? options.minTimeMs : 1.0;
+        options.maxThreads = options.maxThreads ? options.maxThreads : 2;
+    }
+
+    CycleCounter counter;
+    Report report;
+    benchEncrypt(options, counter, report);
+    benchEncryptCall(options, counter, report);
+    benchSetKey(options, counter, report);
+    benchThreads(options, report);
+
+    std::ostringstream context;
+    context << "{\"simd\": " << jsonString(Present::simdInstructionSet())
+            << ", \"player\": " << jsonString(Present::permutationLayerImpl())
+            << ", \"cycle_source\": " << jsonString(counter.source())
+            << ", \"hardware_threads\": " << std::thread::hardware_concurrency()
+            << ", \"repetitions\": " << options.repetitions << ", \"min_time_ms\": " << options.minTimeMs
+            << ", \"quick\": " << (options.quick ? "true" : "false")
+#ifdef __VERSION__
+            << ", \"compiler\": " << jsonString(__VERSION__)
+#endif
+#ifdef NDEBUG
+            << ", \"assertions\": false}";
+#else
+            << ", \"assertions\": true}";
+#endif
+
+    const std::string json = report.json(context.str());
+    if (options.output.empty()) {
+        std::cout << json;
+    } else {
+        std::ofstream file(options.output);
+        file << json;
+        if (!file) {
+            std::cerr << "Cannot write " << options.output << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,350 @@
+#include "present.hh"
+#include "present_rng.hh"
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+// Checks that every batch engine produces exactly the ciphertexts of the scalar
+// Present::encrypt path, including partial batches.
+bool test_batch_matches_scalar(Present::KeySize keySize, int rounds, Present::Engine engine,
+                               const char* engineName) {
+    std::cout << "--- Test Case: encryptBlocks/decryptBlocks (" << engineName << ", "
+              << static_cast<int>(keySize) << "-bit key, " << rounds << " rounds) ---" << std::endl;
+
+    std::mt19937_64 rng(0x5EED0000ULL + static_cast<int>(keySize) + rounds);
+    Present cipher(keySize, rounds);
+
+    std::vector<uint8_t> key(static_cast<size_t>(keySize) / 8);
+    for (auto& b : key) {
+        b = static_cast<uint8_t>(rng());
+    }
+    cipher.setKey(key.data(), key.size());
+
+    const size_t sizes[] = {0, 1, 7, 63, 64, 65, 130, 1000};
+    bool passed = true;
+
+    for (size_t n : sizes) {
+        std::vector<uint64_t> in(n), out(n);
+        for (auto& p : in) {
+            p = rng();
+        }
+
+        cipher.encryptBlocks(in.data(), out.data(), n, engine);
+
+        for (size_t i = 0; i < n; ++i) {
+            if (out[i] != cipher.encrypt(in[i])) {
+                std::cout << "Mismatch at block " << i << " of batch size " << n << std::endl;
+                passed = false;
+                break;
+            }
+        }
+
+        // Decrypting the batch must give the plaintexts back
+        std::vector<uint64_t> back(n);
+        cipher.decryptBlocks(out.data(), back.data(), n, engine);
+        if (back != in) {
+            std::cout << "decryptBlocks does not invert batch of size " << n << std::endl;
+            passed = false;
+        }
+
+        // In-place operation must give the same result
+        cipher.encryptBlocks(in.data(), in.data(), n, engine);
+        if (in != out) {
+            std::cout << "In-place batch of size " << n << " differs" << std::endl;
+            passed = false;
+        }
+        cipher.decryptBlocks(in.data(), in.data(), n, engine);
+        if (in != back) {
+            std::cout << "In-place decryption of size " << n << " differs" << std::endl;
+            passed = false;
+        }
+    }
+
+    std::cout << (passed ? "Test PASSED!" : "Test FAILED!") << std::endl;
+    std::cout << "--- Test Case End ---" << std::endl << std::endl;
+    return passed;
+}
+
+bool test_batch_without_key() {
+    std::cout << "--- Test Case: encryptBlocks/decryptBlocks without key ---" << std::endl;
+
+    Present cipher(Present::KeySize::KEY_80, 31);
+    uint64_t block = 0;
+    bool passed = false;
+    try {
+        cipher.encryptBlocks(&block, &block, 1);
+    } catch (const std::runtime_error&) {
+        passed = true;
+    }
+    bool decryptThrew = false;
+    try {
+        cipher.decryptBlocks(&block, &block, 1);
+    } catch (const std::runtime_error&) {
+        decryptThrew = true;
+    }
+    passed = passed && decryptThrew;
+
+    std::cout << (passed ? "Test PASSED!" : "Test FAILED!") << std::endl;
+    std::cout << "--- Test Case End ---" << std::endl << std::endl;
+    return passed;
+}
+
+// Checks decryptRounds() against reduced-round ciphers: with the same key, the
+// first rounds of a longer cipher use the same round keys, so a cipher with i
+// rounds gives state i XOR roundKey(i).
+bool test_partial_decryption(Present::KeySize keySize) {
+    std::cout << "--- Test Case: decryptRounds (" << static_cast<int>(keySize) << "-bit key) ---" << std::endl;
+
+    const int rounds = 8;
+    std::mt19937_64 rng(0xDEC0DE00ULL + static_cast<int>(keySize));
+    std::vector<uint8_t> key(static_cast<size_t>(keySize) / 8);
+    for (auto& b : key) {
+        b = static_cast<uint8_t>(rng());
+    }
+    Present full(keySize, rounds);
+    full.setKey(key.data(), key.size());
+
+    bool passed = true;
+    for (int trial = 0; trial < 20 && passed; ++trial) {
+        const uint64_t plaintext = rng();
+        std::vector<uint64_t> states(rounds + 1);
+        states[0] = plaintext;
+        for (int i = 1; i <= rounds; ++i) {
+            Present reduced(keySize, i);
+            reduced.setKey(key.data(), key.size());
+            states[i] = reduced.encrypt(plaintext) ^ full.roundKey(i);
+        }
+
+        for (int from = 0; from <= rounds; ++from) {
+            for (int to = 0; to <= from; ++to) {
+                if (full.decryptRounds(states[from], from, to) != states[to]) {
+                    std::cout << "Mismatch from round " << from << " to round " << to << std::endl;
+                    passed = false;
+                }
+            }
+        }
+        if (full.decrypt(full.encrypt(plaintext)) != plaintext) {
+            std::cout << "decrypt() does not invert encrypt()" << std::endl;
+            passed = false;
+        }
+    }
+
+    bool threw = false;
+    try {
+        full.decryptRounds(0, rounds + 1, 0);
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    if (!threw) {
+        std::cout << "Out-of-range round index was accepted" << std::endl;
+        passed = false;
+    }
+
+    std::cout << (passed ? "Test PASSED!" : "Test FAILED!") << std::endl;
+    std::cout << "--- Test Case End ---" << std::endl << std::endl;
+    return passed;
+}
+
+// Checks countDifferential() against a plain encrypt() loop over the same
+// plaintexts. Low round counts and a beta taken from an actual pair keep the
+// expected count well above zero.
+bool test_count_differential(int rounds, Present::Engine engine, const char* engineName) {
+    std::cout << "--- Test Case: countDifferential (" << engineName << ", "
+              << rounds << " rounds) ---" << std::endl;
+
+    const uint64_t alpha = 0x0000000000004004ULL;
+    const uint64_t seed = 0xD1FFULL + rounds;
+    const uint64_t n = 5000 + 37; // Not a multiple of any batch size
+
+    Present cipher(Present::KeySize::KEY_80, rounds);
+    SplitMixRng keyRng(seed);
+    std::vector<uint8_t> key = cipher.generateRandomKey(keyRng);
+    cipher.setKey(key.data(), key.size());
+
+    SplitMixRng reference(seed + 1);
+    uint64_t first = reference.next();
+    const uint64_t beta = cipher.encrypt(first) ^ cipher.encrypt(first ^ alpha);
+    uint64_t expected = 1;
+    for (uint64_t i = 1; i < n; ++i) {
+        uint64_t p = reference.next();
+        expected += (cipher.encrypt(p) ^ cipher.encrypt(p ^ alpha)) == beta;
+    }
+
+    uint64_t hits = cipher.countDifferential(alpha, beta, n, seed + 1, engine);
+    bool passed = hits == expected;
+    if (!passed) {
+        std::cout << "Expected " << expected << " right pairs, got " << hits << std::endl;
+    }
+
+    // Profiling must not change the count
+    Present::CountProfile profile;
+    SplitMixRng profiled(seed + 1);
+    if (cipher.countDifferential(alpha, beta, n, profiled, engine, &profile) != expected) {
+        std::cout << "Count differs with a profile" << std::endl;
+        passed = false;
+    }
+    if (profile.encryptNanos == 0) {
+        std::cout << "Profile recorded no encryption time" << std::endl;
+        passed = false;
+    }
+
+    std::cout << (passed ? "Test PASSED!" : "Test FAILED!") << std::endl;
+    std::cout << "--- Test Case End ---" << std::endl << std::endl;
+    return passed;
+}
+
+// Checks countLinear() against a plain encrypt() loop over the same plaintexts
+bool test_count_linear(int rounds, Present::Engine engine, const char* engineName) {
+    std::cout << "--- Test Case: countLinear (" << engineName << ", "
+              << rounds << " rounds) ---" << std::endl;
+
+    const uint64_t inMask = 0x0000000000200000ULL;  // Bit 21, a fixed point of the pLayer
+    const uint64_t outMask = 0x0000040000200001ULL;
+    const uint64_t seed = 0x11AEULL + rounds;
+    const uint64_t n = 5000 + 37; // Not a multiple of any batch size
+
+    Present cipher(Present::KeySize::KEY_80, rounds);
+    SplitMixRng keyRng(seed);
+    std::vector<uint8_t> key = cipher.generateRandomKey(keyRng);
+    cipher.setKey(key.data(), key.size());
+
+    SplitMixRng reference(seed + 1);
+    uint64_t expected = 0;
+    for (uint64_t i = 0; i < n; ++i) {
+        uint64_t p = reference.next();
+        expected += __builtin_parityll(p & inMask) == __builtin_parityll(cipher.encrypt(p) & outMask);
+    }
+
+    uint64_t holds = cipher.countLinear(inMask, outMask, n, seed + 1, engine);
+    bool passed = holds == expected;
+    if (!passed) {
+        std::cout << "Expected " << expected << " plaintexts, got " << holds << std::endl;
+    }
+
+    std::cout << (passed ? "Test PASSED!" : "Test FAILED!") << std::endl;
+    std::cout << "--- Test Case End ---" << std::endl << std::endl;
+    return passed;
+}
+
+// Checks encryptTrace() against the ciphertexts of the same key with fewer
+// rounds: state i XOR round key i is the i-round ciphertext.
+bool test_encrypt_trace(Present::KeySize keySize, int rounds) {
+    std::cout << "--- Test Case: encryptTrace (" << static_cast<int>(keySize) << "-bit key, "
+              << rounds << " rounds) ---" << std::endl;
+
+    SplitMixRng rng(0x7ACEULL + rounds);
+    Present full(keySize, rounds);
+    std::vector<uint8_t> key = full.generateRandomKey(rng);
+    full.setKey(key.data(), key.size());
+
+    bool passed = true;
+    std::vector<uint64_t> states(rounds + 1);
+    for (int t = 0; t < 16; ++t) {
+        const uint64_t p = rng.next();
+        const uint64_t c = full.encryptTrace(p, states.data());
+        if (c != full.encrypt(p) || states[0] != p) {
+            std::cout << "Trace does not match encrypt() for plaintext " << std::hex << p << std::dec << std::endl;
+            passed = false;
+        }
+        for (int i = 1; i <= rounds; ++i) {
+            Present prefix(keySize, i);
+            prefix.setKey(key.data(), key.size());
+            if ((states[i] ^ full.roundKey(i)) != prefix.encrypt(p)) {
+                std::cout << "State after round " << i << " does not match the " << i
+                          << "-round cipher" << std::endl;
+                passed = false;
+            }
+        }
+    }
+
+    std::cout << (passed ? "Test PASSED!" : "Test FAILED!") << std::endl;
+    std::cout << "--- Test Case End ---" << std::endl << std::endl;
+    return passed;
+}
+
+// Checks countDifferentialRounds() against encryptTrace() over the same
+// plaintexts, with per-round targets taken from an actual pair.
+bool test_count_differential_rounds(int rounds, Present::Engine engine, const char* engineName) {
+    std::cout << "--- Test Case: countDifferentialRounds (" << engineName << ", "
+              << rounds << " rounds) ---" << std::endl;
+
+    const uint64_t alpha = 0x0000000000004004ULL;
+    const uint64_t seed = 0xD1FF00ULL + rounds;
+    const uint64_t n = 5000 + 37; // Not a multiple of any batch size
+
+    Present cipher(Present::KeySize::KEY_80, rounds);
+    SplitMixRng keyRng(seed);
+    std::vector<uint8_t> key = cipher.generateRandomKey(keyRng);
+    cipher.setKey(key.data(), key.size());
+
+    std::vector<uint64_t> a(rounds + 1), b(rounds + 1), betas(rounds);
+    std::vector<uint64_t> expected(rounds, 0);
+    SplitMixRng reference(seed + 1);
+    for (uint64_t i = 0; i < n; ++i) {
+        uint64_t p = reference.next();
+        cipher.encryptTrace(p, a.data());
+        cipher.encryptTrace(p ^ alpha, b.data());
+        for (int r = 0; r < rounds; ++r) {
+            if (i == 0) {
+                betas[r] = a[r + 1] ^ b[r + 1];
+            }
+            expected[r] += (a[r + 1] ^ b[r + 1]) == betas[r];
+        }
+    }
+
+    std::vector<uint64_t> hits(rounds, ~0ULL);
+    cipher.countDifferentialRounds(alpha, betas.data(), n, seed + 1, hits.data(), engine);
+    bool passed = true;
+    for (int r = 0; r < rounds; ++r) {
+        if (hits[r] != expected[r]) {
+            std::cout << "Round " << r + 1 << ": expected " << expected[r] << " right pairs, got "
+                      << hits[r] << std::endl;
+            passed = false;
+        }
+    }
+    if (hits[rounds - 1] != cipher.countDifferential(alpha, betas[rounds - 1], n, seed + 1, engine)) {
+        std::cout << "Last round disagrees with countDifferential()" << std::endl;
+        passed = false;
+    }
+
+    std::cout << (passed ? "Test PASSED!" : "Test FAILED!") << std::endl;
+    std::cout << "--- Test Case End ---" << std::endl << std::endl;
+    return passed;
+}
+
+int main() {
+    struct EngineCase {
+        Present::Engine engine;
+        const char* name;
+    };
+    const EngineCase engines[] = {
+        {Present::Engine::Auto, "auto"},
+        {Present::Engine::Scalar, "scalar"},
+        {Present::Engine::Bitsliced, "bitsliced"},
+        {Present::Engine::Simd, "simd"},
+        {Present::Engine::Table, "table"},
+    };
+
+    std::cout << "SIMD instruction set: " << Present::simdInstructionSet() << std::endl << std::endl;
+
+    bool passed = true;
+    for (const auto& e : engines) {
+        passed &= test_batch_matches_scalar(Present::KeySize::KEY_80, 31, e.engine, e.name);
+        passed &= test_batch_matches_scalar(Present::KeySize::KEY_128, 31, e.engine, e.name);
+        passed &= test_batch_matches_scalar(Present::KeySize::KEY_80, 4, e.engine, e.name);
+        passed &= test_batch_matches_scalar(Present::KeySize::KEY_80, 1, e.engine, e.name);
+        passed &= test_count_differential(2, e.engine, e.name);
+        passed &= test_count_differential(4, e.engine, e.name);
+        passed &= test_count_linear(3, e.engine, e.name);
+        passed &= test_count_differential_rounds(4, e.engine, e.name);
+    }
+    passed &= test_partial_decryption(Present::KeySize::KEY_80);
+    passed &= test_partial_decryption(Present::KeySize::KEY_128);
+    passed &= test_encrypt_trace(Present::KeySize::KEY_80, 31);
+    passed &= test_encrypt_trace(Present::KeySize::KEY_128, 6);
+    passed &= test_batch_without_key();
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+#include "present.hh"
+#include "present_keybatch.hh"
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+// Checks PresentKeyBatch against one Present object per key.
+bool test_keybatch_matches_present(Present::KeySize keySize, int rounds) {
+    std::cout << "--- Test Case: PresentKeyBatch (" << static_cast<int>(keySize) << "-bit keys, "
+              << rounds << " rounds) ---" << std::endl;
+
+    std::mt19937_64 rng(0xC0FFEEULL + static_cast<int>(keySize) + rounds);
+    const size_t keyLength = static_cast<size_t>(keySize) / 8;
+    const size_t keyCounts[] = {1, 63, 64, 65, 200};
+    const uint64_t plaintexts[] = {0x0000000000000000ULL, 0xffffffffffffffffULL, rng(), rng()};
+    const size_t numPlaintexts = sizeof(plaintexts) / sizeof(plaintexts[0]);
+    bool passed = true;
+
+    for (size_t numKeys : keyCounts) {
+        std::vector<uint8_t> keys(numKeys * keyLength);
+        for (auto& b : keys) {
+            b = static_cast<uint8_t>(rng());
+        }
+
+        PresentKeyBatch batch(keySize, rounds);
+        batch.setKeys(keys.data(), numKeys);
+
+        std::vector<uint64_t> out(numPlaintexts * numKeys);
+        batch.encryptBlocks(plaintexts, numPlaintexts, out.data());
+
+        std::vector<uint64_t> single(numKeys);
+        batch.encrypt(plaintexts[2], single.data());
+
+        for (size_t k = 0; k < numKeys && passed; ++k) {
+            Present cipher(keySize, rounds);
+            cipher.setKey(keys.data() + k * keyLength, keyLength);
+            for (size_t p = 0; p < numPlaintexts; ++p) {
+                if (out[p * numKeys + k] != cipher.encrypt(plaintexts[p])) {
+                    std::cout << "Mismatch for key " << k << " of " << numKeys << ", plaintext " << p << std::endl;
+                    passed = false;
+                }
+            }
+            if (single[k] != cipher.encrypt(plaintexts[2])) {
+                std::cout << "encrypt() mismatch for key " << k << " of " << numKeys << std::endl;
+                passed = false;
+            }
+        }
+    }
+
+    std::cout << (passed ? "Test PASSED!" : "Test FAILED!") << std::endl;
+    std::cout << "--- Test Case End ---" << std::endl << std::endl;
+    return passed;
+}
+
+int main() {
+    bool passed = true;
+    passed &= test_keybatch_matches_present(Present::KeySize::KEY_80, 31);
+    passed &= test_keybatch_matches_present(Present::KeySize::KEY_128, 31);
+    passed &= test_keybatch_matches_present(Present::KeySize::KEY_80, 4);
+    passed &= test_keybatch_matches_present(Present::KeySize::KEY_128, 4);
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+#include "present.hh"
+#include "present_t.hh"
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <random>
+
+// The shared building blocks are constexpr: check a few values at compile time.
+static_assert(present_detail::sboxNibble(0x0) == 0xC && present_detail::sboxNibble(0xF) == 0x2,
+              "S-box table");
+static_assert(present_detail::pLayerShift(1ULL << 1) == 1ULL << 16, "pLayer moves bit 1 to bit 16");
+static_assert(present_detail::pLayerShift(1ULL << 62) == 1ULL << 47, "pLayer moves bit 62 to bit 47");
+static_assert(present_detail::sBoxLayer(0) == 0xCCCCCCCCCCCCCCCCULL, "sBoxLayer of zero");
+static_assert(present_detail::tableRound(0x0123456789ABCDEFULL) ==
+              present_detail::pLayerShift(present_detail::sBoxLayer(0x0123456789ABCDEFULL)),
+              "The combined tables agree with sBoxLayer followed by pLayer");
+
+// Checks PresentT<Rounds, K> against the runtime Present for random keys and plaintexts.
+template <int Rounds, Present::KeySize K>
+bool test_present_t_matches_present() {
+    std::cout << "--- Test Case: PresentT<" << Rounds << ", " << static_cast<int>(K)
+              << "> matches Present ---" << std::endl;
+
+    std::mt19937_64 rng(0x7E3A0000ULL + Rounds + static_cast<int>(K));
+    bool passed = true;
+
+    for (int trial = 0; trial < 100 && passed; ++trial) {
+        std::vector<uint8_t> key(PresentT<Rounds, K>::KEY_BYTES);
+        for (auto& b : key) {
+            b = static_cast<uint8_t>(rng());
+        }
+
+        Present reference(K, Rounds);
+        reference.setKey(key.data(), key.size());
+        PresentT<Rounds, K> fixed(key.data());
+
+        for (int i = 0; i < 16; ++i) {
+            uint64_t plaintext = rng();
+            if (fixed.encrypt(plaintext) != reference.encrypt(plaintext)) {
+                std::cout << "Mismatch in trial " << trial << std::endl;
+                passed = false;
+                break;
+            }
+        }
+    }
+
+    std::cout << (passed ? "Test PASSED!" : "Test FAILED!") << std::endl;
+    std::cout << "--- Test Case End ---" << std::endl << std::endl;
+    return passed;
+}
+
+// The 80-bit test vector of the PRESENT paper: all-zero key and plaintext.
+bool test_present_t_known_answer() {
+    std::cout << "--- Test Case: PresentT<31, 80> known answer ---" << std::endl;
+
+    const uint8_t key[10] = {0};
+    PresentT<31, Present::KeySize::KEY_80> cipher(key);
+    bool passed = cipher.encrypt(0) == 0x5579C1387B228445ULL;
+
+    std::cout << (passed ? "Test PASSED!" : "Test FAILED!") << std::endl;
+    std::cout << "--- Test Case End ---" << std::endl << std::endl;
+    return passed;
+}
+
+int main() {
+    bool passed = true;
+    passed &= test_present_t_known_answer();
+    passed &= test_present_t_matches_present<31, Present::KeySize::KEY_80>();
+    passed &= test_present_t_matches_present<31, Present::KeySize::KEY_128>();
+    passed &= test_present_t_matches_present<4, Present::KeySize::KEY_80>();
+    passed &= test_present_t_matches_present<4, Present::KeySize::KEY_128>();
+    passed &= test_present_t_matches_present<1, Present::KeySize::KEY_80>();
+    return passed ? 0 : 1;
+}
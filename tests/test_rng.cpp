@@ -0,0 +1,127 @@
+#include "present.hh"
+#include "present_rng.hh"
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <stdexcept>
+
+// Published first outputs: SplitMix64 from state 0 and Philox4x32-10 with a
+// zero key and counter (Random123 known-answer vectors).
+bool test_known_answers() {
+    std::cout << "--- Test Case: Generator known answers ---" << std::endl;
+    bool passed = true;
+
+    SplitMixRng splitmix(0);
+    const uint64_t splitmixExpected[] = {0xE220A8397B1DCDAFULL, 0x6E789E6AA1B965F4ULL, 0x06C45D188009454FULL};
+    for (uint64_t expected : splitmixExpected) {
+        if (splitmix.next() != expected) {
+            std::cout << "SplitMix64 output mismatch" << std::endl;
+            passed = false;
+        }
+    }
+
+    PhiloxRng philox(0);
+    if (philox.next() != 0xE169C58D6627E8D5ULL || philox.next() != 0x9B00DBD8BC57AC4CULL) {
+        std::cout << "Philox4x32-10 output mismatch" << std::endl;
+        passed = false;
+    }
+
+    std::cout << (passed ? "Test PASSED!" : "Test FAILED!") << std::endl;
+    std::cout << "--- Test Case End ---" << std::endl << std::endl;
+    return passed;
+}
+
+// fillPlaintexts(), next() and discard() must walk the same sequence, and
+// split() must not depend on how far the parent has advanced.
+bool test_stream_consistency(const std::string& name) {
+    std::cout << "--- Test Case: Stream consistency (" << name << ") ---" << std::endl;
+    bool passed = true;
+    const size_t n = 1000;
+
+    std::unique_ptr<Rng> reference = Rng::create(name, 0x1234ULL);
+    std::vector<uint64_t> expected(n);
+    for (auto& v : expected) {
+        v = reference->next();
+    }
+
+    // Bulk fill in uneven pieces, starting at an odd position
+    std::unique_ptr<Rng> bulk = Rng::create(name, 0x1234ULL);
+    std::vector<uint64_t> filled(n);
+    filled[0] = bulk->next();
+    bulk->fillPlaintexts(filled.data() + 1, 130);
+    bulk->fillPlaintexts(filled.data() + 131, n - 131);
+    if (filled != expected) {
+        std::cout << "fillPlaintexts() differs from next()" << std::endl;
+        passed = false;
+    }
+
+    std::unique_ptr<Rng> skipped = Rng::create(name, 0x1234ULL);
+    skipped->discard(777);
+    if (skipped->next() != expected[777]) {
+        std::cout << "discard() lands on the wrong position" << std::endl;
+        passed = false;
+    }
+
+    std::unique_ptr<Rng> a = reference->split(5);
+    std::unique_ptr<Rng> b = Rng::create(name, 0x1234ULL)->split(5);
+    std::unique_ptr<Rng> c = Rng::create(name, 0x1234ULL)->split(6);
+    std::unique_ptr<Rng> d = Rng::create(name, 0x1235ULL)->split(5);
+    uint64_t va = a->next();
+    if (va != b->next()) {
+        std::cout << "split() depends on the parent's position" << std::endl;
+        passed = false;
+    }
+    if (va == c->next() || va == d->next() || va == expected[0]) {
+        std::cout << "split() streams are not distinct" << std::endl;
+        passed = false;
+    }
+
+    std::cout << (passed ? "Test PASSED!" : "Test FAILED!") << std::endl;
+    std::cout << "--- Test Case End ---" << std::endl << std::endl;
+    return passed;
+}
+
+bool test_present_with_rng() {
+    std::cout << "--- Test Case: Present key and plaintext generation from an Rng ---" << std::endl;
+    bool passed = true;
+
+    Present cipher(Present::KeySize::KEY_128);
+    SplitMixRng first(42);
+    SplitMixRng second(42);
+    std::vector<uint8_t> key = cipher.generateRandomKey(first);
+    if (key.size() != 16 || key != cipher.generateRandomKey(second)) {
+        std::cout << "Keys are not reproducible from the seed" << std::endl;
+        passed = false;
+    }
+    if (Present::generateRandomPlaintext(first) != Present::generateRandomPlaintext(second)) {
+        std::cout << "Plaintexts are not reproducible from the seed" << std::endl;
+        passed = false;
+    }
+
+    bool threw = false;
+    try {
+        Rng::create("mt19937", 1);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    if (!threw) {
+        std::cout << "Unknown generator name was accepted" << std::endl;
+        passed = false;
+    }
+
+    std::cout << (passed ? "Test PASSED!" : "Test FAILED!") << std::endl;
+    std::cout << "--- Test Case End ---" << std::endl << std::endl;
+    return passed;
+}
+
+int main() {
+    bool passed = true;
+    passed &= test_known_answers();
+    passed &= test_stream_consistency("splitmix");
+    passed &= test_stream_consistency("philox");
+    passed &= test_stream_consistency("present-ctr");
+    passed &= test_present_with_rng();
+    return passed ? 0 : 1;
+}
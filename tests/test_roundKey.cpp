@@ -31,7 +31,7 @@ void test_all_zero_key_80bit() {
     }
 }
 
-void test_encryption_all_zero_pt_key_80bit() {
+bool test_encryption_all_zero_pt_key_80bit() {
     std::cout << "--- Test Case: PRESENT 80-bit Encryption (All-Zero PT & Key) ---" << std::endl;
 
     Present cipher(Present::KeySize::KEY_80, 31);
@@ -54,7 +54,7 @@ void test_encryption_all_zero_pt_key_80bit() {
         cipher.setKey(key_bytes, sizeof(key_bytes));
     } catch (const std::invalid_argument& e) {
         std::cerr << "Error setting key: " << e.what() << std::endl;
-        return;
+        return false;
     }
 
     uint64_t actual_ciphertext = 0;
@@ -62,29 +62,144 @@ void test_encryption_all_zero_pt_key_80bit() {
         actual_ciphertext = cipher.encrypt(plaintext);
     } catch (const std::runtime_error& e) {
         std::cerr << "Error during encryption: " << e.what() << std::endl;
-        return;
+        return false;
     }
 
     std::cout << "Expected Ciphertext: 0x" << std::hex << std::setw(16) << std::setfill('0') << expected_ciphertext << std::dec << std::endl;
     std::cout << "Actual Ciphertext:   0x" << std::hex << std::setw(16) << std::setfill('0') << actual_ciphertext << std::dec << std::endl;
 
-    if (actual_ciphertext == expected_ciphertext) {
+    bool passed = (actual_ciphertext == expected_ciphertext);
+    if (passed) {
         std::cout << "Test PASSED!" << std::endl;
     } else {
         std::cout << "Test FAILED!" << std::endl;
     }
     std::cout << "--- Test Case End ---" << std::endl << std::endl;
+    return passed;
 }
 
-int main() {
-    test_all_zero_key_80bit();
-    test_encryption_all_zero_pt_key_80bit();
+// Known-answer ciphertexts for 31 rounds, recorded from the original bit-by-bit
+// std::bitset key schedule. The 80-bit all-zero/all-one vectors are those of the
+// PRESENT specification; the 128-bit schedule XORs the round counter into bits
+// k_19..k_15 like the 80-bit one, so its vectors are specific to this implementation.
+bool test_known_answers() {
+    std::cout << "--- Test Case: PRESENT Known-Answer Ciphertexts (80/128-bit) ---" << std::endl;
+
+    struct KnownAnswer {
+        Present::KeySize keySize;
+        int keyPattern; // 0: all 0x00, 1: all 0xFF, 2: bytes 0x01, 0x12, 0x23, ...
+        uint64_t plaintext;
+        uint64_t ciphertext;
+    };
+    const KnownAnswer vectors[] = {
+        {Present::KeySize::KEY_80, 0, 0x0000000000000000ULL, 0x5579c1387b228445ULL},
+        {Present::KeySize::KEY_80, 0, 0xffffffffffffffffULL, 0xa112ffc72f68417bULL},
+        {Present::KeySize::KEY_80, 0, 0x0123456789abcdefULL, 0x6047e90ed080513bULL},
+        {Present::KeySize::KEY_80, 1, 0x0000000000000000ULL, 0xe72c46c0f5945049ULL},
+        {Present::KeySize::KEY_80, 1, 0xffffffffffffffffULL, 0x3333dcd3213210d2ULL},
+        {Present::KeySize::KEY_80, 1, 0x0123456789abcdefULL, 0x0f5663c0f1aa56daULL},
+        {Present::KeySize::KEY_80, 2, 0x0000000000000000ULL, 0x4359065bd748c05eULL},
+        {Present::KeySize::KEY_80, 2, 0xffffffffffffffffULL, 0x938f52df2572227eULL},
+        {Present::KeySize::KEY_80, 2, 0x0123456789abcdefULL, 0x08f950144c59075dULL},
+        {Present::KeySize::KEY_128, 0, 0x0000000000000000ULL, 0x6ada54c3b015c67aULL},
+        {Present::KeySize::KEY_128, 0, 0xffffffffffffffffULL, 0x304f37c848c4d982ULL},
+        {Present::KeySize::KEY_128, 0, 0x0123456789abcdefULL, 0xb314804c7855f138ULL},
+        {Present::KeySize::KEY_128, 1, 0x0000000000000000ULL, 0x7940774d50c90284ULL},
+        {Present::KeySize::KEY_128, 1, 0xffffffffffffffffULL, 0xb5db6a886445dd69ULL},
+        {Present::KeySize::KEY_128, 1, 0x0123456789abcdefULL, 0x4717559b4d26643fULL},
+        {Present::KeySize::KEY_128, 2, 0x0000000000000000ULL, 0x803996682414d4d7ULL},
+        {Present::KeySize::KEY_128, 2, 0xffffffffffffffffULL, 0x6c313bdbce70ff34ULL},
+        {Present::KeySize::KEY_128, 2, 0x0123456789abcdefULL, 0x3409ba45769ad2b7ULL},
+    };
+
+    bool passed = true;
+    for (const auto& v : vectors) {
+        uint8_t key_bytes[16];
+        for (int i = 0; i < 16; ++i) {
+            key_bytes[i] = (v.keyPattern == 0) ? 0x00
+                         : (v.keyPattern == 1) ? 0xFF
+                         : static_cast<uint8_t>(i * 0x11 + 0x01);
+        }
+
+        Present cipher(v.keySize, 31);
+        cipher.setKey(key_bytes, static_cast<size_t>(v.keySize) / 8);
+        uint64_t actual = cipher.encrypt(v.plaintext);
+
+        if (actual != v.ciphertext) {
+            std::cout << "Mismatch for " << static_cast<int>(v.keySize) << "-bit key pattern " << v.keyPattern
+                      << ", plaintext 0x" << std::hex << std::setw(16) << std::setfill('0') << v.plaintext
+                      << ": expected 0x" << std::setw(16) << v.ciphertext
+                      << ", got 0x" << std::setw(16) << actual << std::dec << std::endl;
+            passed = false;
+        }
+        if (cipher.decrypt(v.ciphertext) != v.plaintext) {
+            std::cout << "decrypt() does not invert the vector for " << static_cast<int>(v.keySize)
+                      << "-bit key pattern " << v.keyPattern << std::endl;
+            passed = false;
+        }
+    }
 
-    // You can add more test cases here, for example, for a 128-bit key
-    // or other specific key values if you have known round keys for them.
+    std::cout << (passed ? "Test PASSED!" : "Test FAILED!") << std::endl;
+    std::cout << "--- Test Case End ---" << std::endl << std::endl;
+    return passed;
+}
 
-    std::cout << "Round key test structure executed." << std::endl;
-    std::cout << "Manual verification or further integration with a testing framework is needed for assertion." << std::endl;
+// Checks the related schedule of setRelatedKeys() against setKey(key ^ delta),
+// with differences that do and do not reach the key-schedule S-boxes
+bool test_related_keys() {
+    std::cout << "--- Test Case: PRESENT Related-Key Schedules (80/128-bit) ---" << std::endl;
+
+    bool passed = true;
+    for (Present::KeySize keySize : {Present::KeySize::KEY_80, Present::KeySize::KEY_128}) {
+        const size_t keyLength = static_cast<size_t>(keySize) / 8;
+        for (int pattern = 0; pattern < 4; ++pattern) {
+            uint8_t key_bytes[16];
+            uint8_t delta[16];
+            uint8_t related_bytes[16];
+            for (size_t i = 0; i < keyLength; ++i) {
+                key_bytes[i] = static_cast<uint8_t>(i * 0x37 + 0x5A + pattern);
+                delta[i] = pattern == 0 ? (i == 0 ? 0x80 : 0)          // A single bit
+                         : pattern == 1 ? (i == keyLength - 1 ? 0x01 : 0)
+                         : pattern == 2 ? static_cast<uint8_t>(0x11 * i) // Many active nibbles
+                         : 0;                                            // No difference
+                related_bytes[i] = key_bytes[i] ^ delta[i];
+            }
+
+            Present cipher(keySize, 31);
+            Present related(keySize, 31);
+            Present reference(keySize, 31);
+            cipher.setRelatedKeys(key_bytes, delta, keyLength, related);
+            reference.setKey(related_bytes, keyLength);
+            for (int r = 0; r <= 31; ++r) {
+                if (related.roundKey(r) != reference.roundKey(r)) {
+                    std::cout << "Related round key " << r << " differs for " << static_cast<int>(keySize)
+                              << "-bit difference pattern " << pattern << std::endl;
+                    passed = false;
+                    break;
+                }
+            }
+            reference.setKey(key_bytes, keyLength);
+            if (cipher.encrypt(0x0123456789abcdefULL) != reference.encrypt(0x0123456789abcdefULL)) {
+                std::cout << "Base key differs from setKey() for pattern " << pattern << std::endl;
+                passed = false;
+            }
+        }
+    }
+
+    std::cout << (passed ? "Test PASSED!" : "Test FAILED!") << std::endl;
+    std::cout << "--- Test Case End ---" << std::endl << std::endl;
+    return passed;
+}
+
+int main() {
+    std::cout << "pLayer implementation: " << Present::permutationLayerImpl() << std::endl;
+
+    bool passed = true;
+    test_all_zero_key_80bit();
+    passed &= test_encryption_all_zero_pt_key_80bit();
+    passed &= test_known_answers();
+    passed &= test_related_keys();
 
-    return 0;
+    std::cout << (passed ? "All tests PASSED!" : "Some tests FAILED!") << std::endl;
+    return passed ? 0 : 1;
 }